@@ -1,6 +1,9 @@
 #include "MotorController.h"
 #include "../config/FeedingConfig.h"
 
+// Static members
+MotorController* MotorController::instance_ = nullptr;
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
@@ -12,7 +15,25 @@ MotorController::MotorController()
       pulseOnTime_(FEEDING_PULSE_ON_TIME),
       pulseOffTime_(FEEDING_PULSE_OFF_TIME),
       lastPulseTime_(0),
-      pulsePhase_(false) {
+      pulsePhase_(false),
+      singleShot_(false),
+      pulseTimer_(nullptr),
+      timerReady_(false),
+      nextEdgeUs_(0),
+      onEdgeUs_(0),
+      offEdgeUs_(0),
+      lastOnDurationUs_(0),
+      relayOn_(false),
+      senseActive_(false),
+      senseEdgeUs_(0),
+      senseSeenOn_(false),
+      stallAccumUs_(0),
+      commandedOnUs_(0),
+      senseActiveUs_(0),
+      senseEdges_(0),
+      senseFault_(MOTOR_SENSE_OK) {
+    lock_ = portMUX_INITIALIZER_UNLOCKED;
+    instance_ = this;
 }
 
 // ============================================================================
@@ -30,6 +51,22 @@ void MotorController::begin(uint8_t relayPin, uint8_t sensePin) {
     // Ensure motor is off
     turnOff();
     state_ = MOTOR_IDLE;
+
+    // Capture sense edges with timestamps
+    senseActive_ = isMotorSenseActive();
+    senseEdgeUs_ = esp_timer_get_time();
+    attachInterrupt(digitalPinToInterrupt(sensePin_), senseISR, CHANGE);
+
+    // One-shot timer for pulse edges
+    esp_timer_create_args_t args = {};
+    args.callback = &MotorController::pulseTimerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "motor_pulse";
+    timerReady_ = (esp_timer_create(&args, &pulseTimer_) == ESP_OK);
+    if (!timerReady_) {
+        Serial.println("[MOTOR] WARNING: pulse timer unavailable - using loop-driven pulsing");
+    }
 }
 
 // ============================================================================
@@ -37,31 +74,110 @@ void MotorController::begin(uint8_t relayPin, uint8_t sensePin) {
 // ============================================================================
 
 void MotorController::start() {
+    portENTER_CRITICAL(&lock_);
     if (state_ == MOTOR_IDLE || state_ == MOTOR_STOPPED) {
         turnOn();
         state_ = MOTOR_RUNNING;
     }
+    portEXIT_CRITICAL(&lock_);
 }
 
 void MotorController::stop() {
+    // State first so a callback already in flight sees it and does nothing
+    portENTER_CRITICAL(&lock_);
     turnOff();
     state_ = MOTOR_STOPPED;
+    pulsePhase_ = false;
+    portEXIT_CRITICAL(&lock_);
+
+    if (timerReady_) {
+        esp_timer_stop(pulseTimer_);  // Not armed is fine
+    }
 }
 
 void MotorController::startPulsing(uint16_t onTime, uint16_t offTime) {
+    beginPulse(onTime, offTime, false);
+}
+
+void MotorController::pulseOnce(uint16_t onTime) {
+    // Nothing re-arms after the OFF edge, so a stalled loop cannot cause an extra pulse
+    beginPulse(onTime, 0, true);
+}
+
+void MotorController::beginPulse(uint16_t onTime, uint16_t offTime, bool singleShot) {
+    if (timerReady_) {
+        esp_timer_stop(pulseTimer_);
+    }
+
+    portENTER_CRITICAL(&lock_);
     pulseOnTime_ = onTime;
     pulseOffTime_ = offTime;
+    singleShot_ = singleShot;
 
     // Start with ON phase
     turnOn();
     pulsePhase_ = true;
     lastPulseTime_ = millis();
+    nextEdgeUs_ = esp_timer_get_time() + (int64_t)onTime * 1000;  // Relay may already be on
     state_ = MOTOR_PULSING;
+    portEXIT_CRITICAL(&lock_);
+
+    if (timerReady_) {
+        armPulseTimer();
+    }
 }
 
 void MotorController::setPulseTimings(uint16_t onTime, uint16_t offTime) {
+    // Takes effect from the next edge
+    portENTER_CRITICAL(&lock_);
     pulseOnTime_ = onTime;
     pulseOffTime_ = offTime;
+    portEXIT_CRITICAL(&lock_);
+}
+
+// ============================================================================
+// PULSE TIMER
+// ============================================================================
+
+void MotorController::pulseTimerCallback(void* arg) {
+    static_cast<MotorController*>(arg)->onPulseTimer();
+}
+
+void MotorController::onPulseTimer() {
+    portENTER_CRITICAL(&lock_);
+    if (state_ != MOTOR_PULSING) {
+        // stop() won the race - leave the relay alone
+        portEXIT_CRITICAL(&lock_);
+        return;
+    }
+
+    // Next edge is scheduled from the previous deadline, so callback latency doesn't accumulate
+    if (pulsePhase_ && singleShot_) {
+        turnOff();
+        pulsePhase_ = false;
+        state_ = MOTOR_STOPPED;
+        portEXIT_CRITICAL(&lock_);
+        return;  // Single pulse done - no re-arm
+    } else if (pulsePhase_) {
+        turnOff();
+        pulsePhase_ = false;
+        nextEdgeUs_ += (int64_t)pulseOffTime_ * 1000;
+    } else {
+        turnOn();
+        pulsePhase_ = true;
+        nextEdgeUs_ += (int64_t)pulseOnTime_ * 1000;
+    }
+    portEXIT_CRITICAL(&lock_);
+
+    armPulseTimer();
+}
+
+void MotorController::armPulseTimer() {
+    int64_t delayUs = nextEdgeUs_ - esp_timer_get_time();
+    if (delayUs < 0) {
+        delayUs = 0;
+    }
+    esp_timer_start_once(pulseTimer_, (uint64_t)delayUs);
 }
 
 // ============================================================================
@@ -69,19 +185,26 @@ void MotorController::setPulseTimings(uint16_t onTime, uint16_t offTime) {
 // ============================================================================
 
 void MotorController::update() {
-    if (state_ != MOTOR_PULSING) {
-        return;  // Only update if pulsing
+    checkSense();
+
+    if (timerReady_ || state_ != MOTOR_PULSING) {
+        return;  // Edges come from the pulse timer, or not pulsing
     }
 
+    // Fallback: loop-driven pulsing (edges jitter with loop latency)
     unsigned long currentTime = millis();
     unsigned long elapsed = currentTime - lastPulseTime_;
 
+    portENTER_CRITICAL(&lock_);
     if (pulsePhase_) {
         // Currently ON - check if time to turn OFF
         if (elapsed >= pulseOnTime_) {
             turnOff();
             pulsePhase_ = false;
             lastPulseTime_ = currentTime;
+            if (singleShot_) {
+                state_ = MOTOR_STOPPED;
+            }
         }
     } else {
         // Currently OFF - check if time to turn ON
@@ -91,6 +214,114 @@ void MotorController::update() {
             lastPulseTime_ = currentTime;
         }
     }
+    portEXIT_CRITICAL(&lock_);
+}
+
+// ============================================================================
+// SENSE CAPTURE
+// ============================================================================
+
+void IRAM_ATTR MotorController::senseISR() {
+    MotorController* self = instance_;
+    if (!self) return;
+
+    int64_t now = esp_timer_get_time();
+    bool active = (digitalRead(self->sensePin_) == LOW);
+
+    portENTER_CRITICAL_ISR(&self->lock_);
+    if (active != self->senseActive_) {
+        if (active) {
+            if (self->relayOn_) {
+                self->senseSeenOn_ = true;
+                self->stallAccumUs_ = 0;
+            }
+        } else {
+            self->senseActiveUs_ += now - self->senseEdgeUs_;
+        }
+        self->senseActive_ = active;
+        self->senseEdgeUs_ = now;
+        self->senseEdges_++;
+    }
+    portEXIT_CRITICAL_ISR(&self->lock_);
+}
+
+void MotorController::checkSense() {
+#if MOTOR_SENSE_STALL_DETECTION
+    if (senseFault_ != MOTOR_SENSE_OK) {
+        return;  // Latched
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    // Stall: relay-on time with no sense activity, summed across consecutive short pulses,
+    // or sense gone inactive partway through an ON period (motor stopped mid-run)
+    // Run-on: sense still active this long after the relay opened (coast-down allowed)
+    portENTER_CRITICAL(&lock_);
+    int64_t stallUs = stallAccumUs_;
+    bool droppedOut = false;
+    if (relayOn_ && !senseSeenOn_) {
+        stallUs += now - onEdgeUs_;
+    } else if (relayOn_ && !senseActive_) {
+        stallUs = now - max(senseEdgeUs_, onEdgeUs_);
+        droppedOut = true;
+    }
+    int64_t runOnUs = 0;
+    if (!relayOn_ && senseActive_) {
+        runOnUs = now - max(offEdgeUs_, senseEdgeUs_);
+    }
+    portEXIT_CRITICAL(&lock_);
+
+    if (stallUs >= (int64_t)MOTOR_SENSE_STALL_TIME * 1000) {
+        senseFault_ = MOTOR_SENSE_STALL;
+        stop();
+        Serial.printf("[MOTOR] FAULT: stall - relay on %lu ms with %s\n",
+                      (unsigned long)(stallUs / 1000),
+                      droppedOut ? "sense inactive mid-run" : "no sense activity");
+    } else if (runOnUs >= (int64_t)MOTOR_SENSE_RUN_ON_TIME * 1000) {
+        senseFault_ = MOTOR_SENSE_RUN_ON;
+        stop();
+        Serial.printf("[MOTOR] FAULT: run-on - sense active %lu ms after relay off\n",
+                      (unsigned long)(runOnUs / 1000));
+    }
+#endif
+}
+
+MotorSenseFault MotorController::getSenseFault() const {
+    return senseFault_;
+}
+
+void MotorController::clearSenseFault() {
+    portENTER_CRITICAL(&lock_);
+    senseFault_ = MOTOR_SENSE_OK;
+    stallAccumUs_ = 0;
+    portEXIT_CRITICAL(&lock_);
+}
+
+MotorSenseStats MotorController::getSenseStats() const {
+    int64_t now = esp_timer_get_time();
+    MotorSenseStats stats;
+
+    portENTER_CRITICAL(&lock_);
+    uint64_t onUs = commandedOnUs_ + (relayOn_ ? now - onEdgeUs_ : 0);
+    uint64_t activeUs = senseActiveUs_ + (senseActive_ ? now - senseEdgeUs_ : 0);
+    stats.edges = senseEdges_;
+    portEXIT_CRITICAL(&lock_);
+
+    stats.commandedOnMs = onUs / 1000;
+    stats.senseActiveMs = activeUs / 1000;
+    return stats;
+}
+
+void MotorController::resetSenseStats() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock_);
+    commandedOnUs_ = 0;
+    senseActiveUs_ = 0;
+    senseEdges_ = 0;
+    // Restart any period in progress so it only counts from here
+    if (relayOn_) onEdgeUs_ = now;
+    if (senseActive_) senseEdgeUs_ = now;
+    portEXIT_CRITICAL(&lock_);
 }
 
 // ============================================================================
@@ -105,10 +336,35 @@ bool MotorController::isPulsing() const {
     return (state_ == MOTOR_PULSING);
 }
 
+bool MotorController::isPulseComplete() const {
+    return (state_ == MOTOR_STOPPED);
+}
+
 MotorState MotorController::getState() const {
     return state_;
 }
 
+uint32_t MotorController::getLastOnDurationUs() const {
+    portENTER_CRITICAL(&lock_);
+    uint32_t duration = lastOnDurationUs_;
+    portEXIT_CRITICAL(&lock_);
+    return duration;
+}
+
+int64_t MotorController::getLastOnEdgeUs() const {
+    portENTER_CRITICAL(&lock_);
+    int64_t edge = onEdgeUs_;
+    portEXIT_CRITICAL(&lock_);
+    return edge;
+}
+
+int64_t MotorController::getLastOffEdgeUs() const {
+    portENTER_CRITICAL(&lock_);
+    int64_t edge = offEdgeUs_;
+    portEXIT_CRITICAL(&lock_);
+    return edge;
+}
+
 bool MotorController::isMotorSenseActive() const {
     // LOW = motor running, HIGH = motor stopped
     return (digitalRead(sensePin_) == LOW);
@@ -120,8 +376,25 @@ bool MotorController::isMotorSenseActive() const {
 
 void MotorController::turnOn() {
     digitalWrite(relayPin_, LOW);
+    if (!relayOn_) {
+        onEdgeUs_ = esp_timer_get_time();
+        relayOn_ = true;
+        // Motor may still be turning from the previous pulse
+        senseSeenOn_ = senseActive_;
+        if (senseSeenOn_) stallAccumUs_ = 0;
+    }
 }
 
 void MotorController::turnOff() {
     digitalWrite(relayPin_, HIGH);
+    int64_t now = esp_timer_get_time();
+    if (relayOn_) {
+        // Closing an ON period - record its real length
+        int64_t onUs = now - onEdgeUs_;
+        lastOnDurationUs_ = (uint32_t)onUs;
+        commandedOnUs_ += onUs;
+        if (!senseSeenOn_) stallAccumUs_ += onUs;
+        relayOn_ = false;
+    }
+    offEdgeUs_ = now;
 }
@@ -1,12 +1,20 @@
 #pragma once
 
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
 
 // ============================================================================
 // MOTOR CONTROLLER
 // ============================================================================
 // Non-blocking motor control with FSM for pulsing
 // States: IDLE → RUNNING → PULSING → STOPPED
+// Pulse edges are driven by an esp_timer one-shot, so ON/OFF timing does not
+// depend on main loop latency; update() only toggles if the timer is unavailable
+// pulseOnce() runs a single ON period and ends in MOTOR_STOPPED (pulse-and-weigh);
+// startPulsing() repeats ON/OFF until stop() (manual feed)
+// MOTOR_SENSE_PIN is captured by interrupt and cross-checked against the
+// commanded relay state to latch stall / run-on faults within a few hundred ms
 
 enum MotorState {
     MOTOR_IDLE,      // Motor off, ready
@@ -15,6 +23,20 @@ enum MotorState {
     MOTOR_STOPPED    // Motor stopped (post-operation)
 };
 
+// Sense-pin cross-check result (latched until clearSenseFault())
+enum MotorSenseFault {
+    MOTOR_SENSE_OK,
+    MOTOR_SENSE_STALL,    // Relay on, sense never went active or dropped out mid-run (jammed auger / dead motor)
+    MOTOR_SENSE_RUN_ON    // Relay off, sense still active (welded relay / wiring fault)
+};
+
+// Sense-signal statistics since resetSenseStats() (one feed)
+struct MotorSenseStats {
+    uint32_t commandedOnMs;   // Total relay-on time
+    uint32_t senseActiveMs;   // Total sense-active time
+    uint16_t edges;           // Sense transitions
+};
+
 class MotorController {
 public:
     MotorController();
@@ -25,32 +47,92 @@ public:
     // Control methods
     void start();                           // Start motor (continuous)
     void stop();                            // Stop motor
-    void startPulsing(uint16_t onTime, uint16_t offTime);  // Start pulsing mode
+    void startPulsing(uint16_t onTime, uint16_t offTime);  // Start pulsing mode (repeats until stop())
+    void pulseOnce(uint16_t onTime);        // One ON period, then relay off and MOTOR_STOPPED (no re-arm)
     void setPulseTimings(uint16_t onTime, uint16_t offTime);  // Update pulse timings
 
-    // Update FSM (call from main loop)
+    // Update FSM (call from main loop) - fallback pulsing only
     void update();
 
     // Status
     bool isRunning() const;
     bool isPulsing() const;
+    bool isPulseComplete() const;           // pulseOnce() finished (or motor stopped)
     MotorState getState() const;
 
+    // Actual duration of the most recent completed ON period (us, from edge timestamps)
+    uint32_t getLastOnDurationUs() const;
+
+    // esp_timer_get_time() of the most recent ON / OFF edge
+    int64_t getLastOnEdgeUs() const;
+    int64_t getLastOffEdgeUs() const;
+
     // Hardware sense (LOW=running, HIGH=stopped)
     bool isMotorSenseActive() const;
 
+    // Sense cross-check (checked in update(); a stall also stops the motor)
+    MotorSenseFault getSenseFault() const;
+    void clearSenseFault();
+
+    // Per-feed sense duty statistics (includes the period in progress)
+    MotorSenseStats getSenseStats() const;
+    void resetSenseStats();
+
+    // ISR handler (must be static)
+    static void IRAM_ATTR senseISR();
+
 private:
     uint8_t relayPin_;
     uint8_t sensePin_;
-    MotorState state_;
+    volatile MotorState state_;
 
     // Pulsing control
     uint16_t pulseOnTime_;
     uint16_t pulseOffTime_;
-    unsigned long lastPulseTime_;
-    bool pulsePhase_;  // true=ON, false=OFF
+    unsigned long lastPulseTime_;      // millis() of last edge (fallback path)
+    volatile bool pulsePhase_;         // true=ON, false=OFF
+    bool singleShot_;                  // pulseOnce(): stop at the OFF edge
+
+    // Hardware pulse timer
+    esp_timer_handle_t pulseTimer_;
+    bool timerReady_;
+    int64_t nextEdgeUs_;               // Scheduled time of the next pulse edge
+
+    // Edge timestamps (written under lock_)
+    int64_t onEdgeUs_;
+    int64_t offEdgeUs_;
+    uint32_t lastOnDurationUs_;
+
+    // Commanded relay state and sense capture (written under lock_)
+    volatile bool relayOn_;
+    volatile bool senseActive_;        // Last sampled sense level
+    int64_t senseEdgeUs_;              // Time of last sense transition
+    bool senseSeenOn_;                 // Sense went active during the current ON period
+    int64_t stallAccumUs_;             // Consecutive relay-on time without sense activity
+    uint64_t commandedOnUs_;           // Stats accumulators
+    uint64_t senseActiveUs_;
+    uint16_t senseEdges_;
+    volatile MotorSenseFault senseFault_;
+
+    static MotorController* instance_;
+
+    // Guards state_/pulsePhase_/relay/sense between timer task, ISR and main loop
+    mutable portMUX_TYPE lock_;
+
+    // Compare commanded relay state with sense timing and latch faults
+    void checkSense();
+
+    // Timer callback (runs in esp_timer task)
+    static void pulseTimerCallback(void* arg);
+    void onPulseTimer();
+
+    // Start pulsing with the ON phase (shared by startPulsing / pulseOnce)
+    void beginPulse(uint16_t onTime, uint16_t offTime, bool singleShot);
+
+    // Arm the one-shot for the edge due at nextEdgeUs_
+    void armPulseTimer();
 
-    // Hardware control
+    // Hardware control (call with lock_ held; they record edge timestamps)
     void turnOn();
     void turnOff();
 };
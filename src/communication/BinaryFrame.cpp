@@ -0,0 +1,168 @@
+#include "BinaryFrame.h"
+
+// CRC-16/CCITT-FALSE nibble table (32 bytes instead of a 512-byte full table)
+static const uint16_t CRC16_NIBBLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+uint16_t BinaryFrame::crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+size_t BinaryFrame::encode(uint8_t type, const void* payload, size_t len, uint8_t* out) {
+    if (len > MAX_PAYLOAD) {
+        return 0;
+    }
+
+    // Body: type | payload | crc16 LE
+    uint8_t body[1 + MAX_PAYLOAD + 2];
+    body[0] = type;
+    if (len > 0) {
+        memcpy(body + 1, payload, len);
+    }
+    uint16_t crc = crc16(body, 1 + len);
+    body[1 + len] = crc & 0xFF;
+    body[2 + len] = crc >> 8;
+    size_t bodyLen = len + 3;
+
+    // COBS: each block starts with the distance to the next zero (or 0xFF for 254 non-zero bytes)
+    size_t codeIndex = 0;
+    size_t outLen = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < bodyLen; i++) {
+        if (body[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = outLen++;
+            code = 1;
+        } else {
+            out[outLen++] = body[i];
+            if (++code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = outLen++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    out[outLen++] = 0x00;  // Delimiter
+    return outLen;
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+BinaryFrameDecoder::BinaryFrameDecoder()
+    : rawLen_(0),
+      overflow_(false),
+      bodyLen_(0),
+      errors_(0),
+      consecutiveErrors_(0) {
+}
+
+void BinaryFrameDecoder::reset() {
+    rawLen_ = 0;
+    overflow_ = false;
+    consecutiveErrors_ = 0;
+}
+
+bool BinaryFrameDecoder::feed(uint8_t byte) {
+    if (byte != 0x00) {
+        if (rawLen_ < sizeof(raw_)) {
+            raw_[rawLen_++] = byte;
+        } else {
+            // Too long for any frame - count it now and start over, so a peer that
+            // never sends delimiters (e.g. restarted in ASCII) keeps showing errors;
+            // the tail is dropped at the next delimiter
+            overflow_ = true;
+            rawLen_ = 0;
+            countError();
+        }
+        return false;
+    }
+
+    // Delimiter: decode what was collected
+    bool ok = false;
+    if (rawLen_ > 0) {
+        if (overflow_) {
+            // Already counted
+        } else if (decode()) {
+            ok = true;
+        } else {
+            countError();
+        }
+    }
+    rawLen_ = 0;
+    overflow_ = false;
+    return ok;
+}
+
+bool BinaryFrameDecoder::decode() {
+    size_t in = 0;
+    bodyLen_ = 0;
+    while (in < rawLen_) {
+        uint8_t code = raw_[in++];
+        if (code == 0 || in + code - 1 > rawLen_) {
+            return false;  // Block runs past the frame
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            body_[bodyLen_++] = raw_[in++];
+        }
+        // A short block implies a zero, except at the very end
+        if (code < 0xFF && in < rawLen_) {
+            body_[bodyLen_++] = 0x00;
+        }
+    }
+
+    // type + crc at minimum
+    if (bodyLen_ < 3) {
+        return false;
+    }
+    uint16_t received = body_[bodyLen_ - 2] | (body_[bodyLen_ - 1] << 8);
+    if (BinaryFrame::crc16(body_, bodyLen_ - 2) != received) {
+        return false;
+    }
+
+    consecutiveErrors_ = 0;
+    return true;
+}
+
+void BinaryFrameDecoder::countError() {
+    errors_++;
+    if (consecutiveErrors_ < 255) {
+        consecutiveErrors_++;
+    }
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+uint8_t BinaryFrameDecoder::type() const {
+    return body_[0];
+}
+
+const uint8_t* BinaryFrameDecoder::payload() const {
+    return body_ + 1;
+}
+
+size_t BinaryFrameDecoder::length() const {
+    return bodyLen_ - 3;
+}
+
+uint32_t BinaryFrameDecoder::getErrorCount() const {
+    return errors_;
+}
+
+uint8_t BinaryFrameDecoder::getConsecutiveErrors() const {
+    return consecutiveErrors_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// BINARY FRAME (COBS + CRC16)
+// ============================================================================
+// Wire format of one frame:
+//   COBS( type:u8 | payload[0..MAX_PAYLOAD] | crc16:u16 LE ) 0x00
+// COBS removes every 0x00 from the body, so 0x00 only ever marks a frame end
+// and the receiver resynchronises on the next delimiter after any corruption
+// CRC16 is CCITT-FALSE (poly 0x1021, init 0xFFFF) over type + payload
+
+class BinaryFrame {
+public:
+    static const size_t MAX_PAYLOAD = 250;
+    // Body (type + payload + crc) plus COBS overhead (1 per 254) plus delimiter
+    static const size_t MAX_ENCODED = 1 + MAX_PAYLOAD + 2 + 2 + 1;
+
+    // Encode one frame into out (at least MAX_ENCODED bytes); returns bytes written, 0 if too long
+    static size_t encode(uint8_t type, const void* payload, size_t len, uint8_t* out);
+
+    // CRC-16/CCITT-FALSE, chainable
+    static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+};
+
+// ============================================================================
+// FRAME DECODER
+// ============================================================================
+// Byte-at-a-time receiver: feed() returns true once a complete frame with a
+// valid CRC has arrived; type()/payload()/length() are valid until the next feed()
+
+class BinaryFrameDecoder {
+public:
+    BinaryFrameDecoder();
+
+    void reset();
+
+    // Consume one byte; true = a valid frame is ready
+    bool feed(uint8_t byte);
+
+    uint8_t type() const;
+    const uint8_t* payload() const;
+    size_t length() const;
+
+    // Frames dropped (bad COBS, bad CRC, too long or too short)
+    uint32_t getErrorCount() const;
+
+    // Consecutive bad frames since the last good one (link health)
+    uint8_t getConsecutiveErrors() const;
+
+private:
+    // Encoded bytes of the frame being received (without delimiter)
+    uint8_t raw_[BinaryFrame::MAX_ENCODED];
+    size_t rawLen_;
+    bool overflow_;
+
+    // Decoded body of the last good frame
+    uint8_t body_[BinaryFrame::MAX_ENCODED];
+    size_t bodyLen_;
+
+    uint32_t errors_;
+    uint8_t consecutiveErrors_;
+
+    bool decode();
+    void countError();
+};
@@ -0,0 +1,211 @@
+#include "CommandDispatcher.h"
+
+// FNV-1a 32-bit (same constants as the schedule ids)
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+constexpr uint32_t commandHash(const char* s, uint32_t h = FNV_OFFSET_BASIS) {
+    return *s ? commandHash(s + 1, (h ^ (uint8_t)*s) * FNV_PRIME) : h;
+}
+
+#define COMMAND(id, name, args, modes) { id, name, args, modes, sizeof(name) - 1, commandHash(name) }
+
+// ============================================================================
+// COMMAND TABLE (CommandId order)
+// ============================================================================
+
+static constexpr CommandSpec COMMAND_TABLE[] = {
+    COMMAND(CMD_FEED_NOW,            "FEED_NOW",            "",       CMD_MODE_IDLE),
+    COMMAND(CMD_STOP,                "STOP",                "",       CMD_MODE_ANY),
+    COMMAND(CMD_TARE,                "TARE",                "",       CMD_MODE_IDLE),
+    COMMAND(CMD_RESET_FLOW,          "RESET_FLOW",          "",       CMD_MODE_ANY),
+    COMMAND(CMD_OTA_START,           "OTA_START",           "u?u",    CMD_MODE_ANY),   // <bytes>[:<crc32>]
+    COMMAND(CMD_STATUS_KEYFRAME,     "STATUS_KEYFRAME",     "",       CMD_MODE_ANY),
+    COMMAND(CMD_CLEAR_FAULTS,        "CLEAR_FAULTS",        "",       CMD_MODE_ANY),
+    COMMAND(CMD_GET_SCHEDULE_STATUS, "GET_SCHEDULE_STATUS", "",       CMD_MODE_ANY),
+    COMMAND(CMD_GET_LINK_STATS,      "GET_LINK_STATS",      "",       CMD_MODE_ANY),
+    COMMAND(CMD_TIME,                "TIME",                "s",      CMD_MODE_ANY),   // RTCManager parses the stamp
+    COMMAND(CMD_NAME,                "NAME",                "?s",     CMD_MODE_ANY),
+    COMMAND(CMD_SCHEDULES,           "SCHEDULES",           "?s",     CMD_MODE_ANY),   // Streamed on the ASCII link
+    COMMAND(CMD_SCHEDULE_UPSERT,     "SCHEDULE_UPSERT",     "utxu?u", CMD_MODE_ANY),   // <id>,<HH:MM>,<mask>,<grams>[,<enabled>]
+    COMMAND(CMD_SCHEDULE_DELETE,     "SCHEDULE_DELETE",     "u",      CMD_MODE_ANY),
+    COMMAND(CMD_SCHEDULE_DIGEST,     "SCHEDULE_DIGEST",     "",       CMD_MODE_ANY),
+    COMMAND(CMD_LINK_BINARY,         "LINK:BINARY",         "",       CMD_MODE_ANY),
+    COMMAND(CMD_LINK_ASCII,          "LINK:ASCII",          "",       CMD_MODE_ANY),
+    COMMAND(CMD_LINK_BAUD,           "LINK:BAUD",           "u?w",    CMD_MODE_ANY),   // <rate>[:RTSCTS]
+    COMMAND(CMD_LINK_TEST,           "LINK:TEST",           "s",      CMD_MODE_ANY),
+    COMMAND(CMD_HELP,                "HELP",                "",       CMD_MODE_ANY),
+};
+
+static_assert(sizeof(COMMAND_TABLE) / sizeof(COMMAND_TABLE[0]) == CMD_COUNT,
+              "COMMAND_TABLE needs exactly one entry per CommandId");
+
+constexpr bool idsInOrder(int i) {
+    return i >= CMD_COUNT || (COMMAND_TABLE[i].id == i && idsInOrder(i + 1));
+}
+static_assert(idsInOrder(0), "COMMAND_TABLE must list commands in CommandId order");
+
+constexpr bool bucketUnique(int i, int j) {
+    return j >= CMD_COUNT ||
+           (COMMAND_TABLE[i].hash % CMD_HASH_BUCKETS != COMMAND_TABLE[j].hash % CMD_HASH_BUCKETS &&
+            bucketUnique(i, j + 1));
+}
+constexpr bool perfectHash(int i) {
+    return i >= CMD_COUNT || (bucketUnique(i, i + 1) && perfectHash(i + 1));
+}
+static_assert(perfectHash(0), "Command names collide in the hash table - change CMD_HASH_BUCKETS");
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+CommandDispatcher::CommandDispatcher() {
+    memset(buckets_, 0, sizeof(buckets_));
+    for (int i = 0; i < CMD_COUNT; i++) {
+        buckets_[COMMAND_TABLE[i].hash % CMD_HASH_BUCKETS] = i + 1;
+    }
+}
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+
+CommandStatus CommandDispatcher::parse(char* line, uint8_t mode,
+                                       const CommandSpec*& spec, CommandArgs& args) const {
+    spec = nullptr;
+
+    // Verb = shortest prefix ending at ':' or end of line that is in the table
+    // (so LINK:BAUD:921600 resolves to LINK:BAUD, TIME:12:00 to TIME)
+    uint32_t hash = FNV_OFFSET_BASIS;
+    char* c = line;
+    while (true) {
+        if (*c == ':' || *c == '\0') {
+            spec = lookup(hash, c - line, line);
+            if (spec || *c == '\0') {
+                break;
+            }
+        }
+        hash = (hash ^ (uint8_t)*c) * FNV_PRIME;
+        c++;
+    }
+    if (!spec) {
+        return CMD_UNKNOWN;
+    }
+
+    if (!parseArgs(*c == ':' ? c + 1 : nullptr, spec->args, args)) {
+        return CMD_BAD_ARGS;
+    }
+    if (!(spec->modes & mode)) {
+        return CMD_WRONG_MODE;
+    }
+    return CMD_OK;
+}
+
+const CommandSpec* CommandDispatcher::lookup(uint32_t hash, size_t length, const char* name) const {
+    uint8_t slot = buckets_[hash % CMD_HASH_BUCKETS];
+    if (slot == 0) {
+        return nullptr;
+    }
+    const CommandSpec& spec = COMMAND_TABLE[slot - 1];
+    if (spec.hash != hash || spec.nameLength != length || strncmp(spec.name, name, length) != 0) {
+        return nullptr;
+    }
+    return &spec;
+}
+
+bool CommandDispatcher::parseArgs(char* text, const char* schema, CommandArgs& args) {
+    memset(&args, 0, sizeof(args));
+    bool optional = false;
+
+    for (const char* s = schema; *s; s++) {
+        if (*s == '?') {
+            optional = true;
+            continue;
+        }
+        if (!text || *text == '\0') {
+            return optional;  // Ran out of arguments
+        }
+
+        char* end = text;
+        uint32_t value = 0;
+        switch (*s) {
+            case 'u':
+            case 'x':
+                if (*text < '0' || *text > '9') return false;
+                value = strtoul(text, &end, *s == 'u' ? 10 : 0);
+                break;
+
+            case 't': {
+                unsigned long hour = strtoul(text, &end, 10);
+                if (end == text || *end != ':') return false;
+                char* minuteText = end + 1;
+                unsigned long minute = strtoul(minuteText, &end, 10);
+                if (end == minuteText || hour > 23 || minute > 59) return false;
+                value = hour * 60 + minute;
+                break;
+            }
+
+            case 'w':
+                end = text + strcspn(text, ":,");
+                args.text = text;
+                break;
+
+            case 's':
+                end = text + strlen(text);
+                args.text = text;
+                break;
+
+            default:
+                return false;
+        }
+
+        if (args.count < CMD_MAX_ARGS) {
+            args.num[args.count] = value;
+        }
+        args.count++;
+
+        // Separator (terminates a word argument in place)
+        if (*end == '\0') {
+            text = nullptr;
+        } else if (*end == ':' || *end == ',') {
+            *end = '\0';
+            text = end + 1;
+        } else {
+            return false;  // Junk after a number
+        }
+    }
+
+    // Nothing may follow the last argument
+    return !text || *text == '\0';
+}
+
+// ============================================================================
+// TABLE ACCESS
+// ============================================================================
+
+const CommandSpec& CommandDispatcher::getSpec(int index) {
+    return COMMAND_TABLE[index];
+}
+
+int CommandDispatcher::getCount() {
+    return CMD_COUNT;
+}
+
+const char* CommandDispatcher::modeName(uint8_t modes) {
+    switch (modes & CMD_MODE_ANY) {
+        case CMD_MODE_IDLE:    return "idle";
+        case CMD_MODE_FEEDING: return "feeding";
+        case CMD_MODE_ANY:     return "any";
+        default:               return "none";
+    }
+}
+
+const char* CommandDispatcher::statusName(CommandStatus status) {
+    switch (status) {
+        case CMD_OK:         return "ok";
+        case CMD_UNKNOWN:    return "unknown";
+        case CMD_BAD_ARGS:   return "args";
+        case CMD_WRONG_MODE: return "busy";
+        default:             return "error";
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// COMMAND DISPATCHER
+// ============================================================================
+// Single table of every verb the WiFi ESP may send (see CommandDispatcher.cpp):
+// name, argument schema and the system modes it is allowed in. The verb is
+// found in O(1) through a perfect hash (FNV-1a, collision-free by static_assert)
+// and arguments are parsed once, by schema, into CommandArgs for the handler.
+// HELP answers with the same table so the WiFi ESP can discover what is supported.
+//
+// Argument schema characters (arguments are separated by ':' or ','):
+//   u  unsigned decimal          x  unsigned, decimal or 0x hex
+//   t  HH:MM -> minute of day    w  word (up to the next separator)
+//   s  rest of the line          ?  following arguments are optional
+
+enum CommandId {
+    // Feeding / hardware (handled in main.cpp)
+    CMD_FEED_NOW,
+    CMD_STOP,
+    CMD_TARE,
+    CMD_RESET_FLOW,
+    CMD_OTA_START,
+    CMD_STATUS_KEYFRAME,
+
+    // Protocol (handled in SerialProtocol)
+    CMD_CLEAR_FAULTS,
+    CMD_GET_SCHEDULE_STATUS,
+    CMD_GET_LINK_STATS,
+    CMD_TIME,
+    CMD_NAME,
+    CMD_SCHEDULES,
+    CMD_SCHEDULE_UPSERT,
+    CMD_SCHEDULE_DELETE,
+    CMD_SCHEDULE_DIGEST,
+    CMD_LINK_BINARY,
+    CMD_LINK_ASCII,
+    CMD_LINK_BAUD,
+    CMD_LINK_TEST,
+    CMD_HELP,
+
+    CMD_COUNT
+};
+
+// Allowed system modes (bitmask)
+#define CMD_MODE_IDLE    0x01    // Not feeding
+#define CMD_MODE_FEEDING 0x02    // Feeding in progress
+#define CMD_MODE_ANY     (CMD_MODE_IDLE | CMD_MODE_FEEDING)
+
+#define CMD_MAX_ARGS 5
+#define CMD_HASH_BUCKETS 79      // Perfect hash table size (collision-free, checked at compile time)
+
+struct CommandSpec {
+    CommandId id;
+    const char* name;
+    const char* args;            // Schema (see above)
+    uint8_t modes;
+    uint8_t nameLength;
+    uint32_t hash;               // FNV-1a of name
+};
+
+// Arguments parsed by schema (valid for the handler call only)
+struct CommandArgs {
+    uint8_t count;               // Arguments present
+    uint32_t num[CMD_MAX_ARGS];  // u / x / t values by position
+    const char* text;            // Last w / s argument (points into the line)
+};
+
+enum CommandStatus {
+    CMD_OK,
+    CMD_UNKNOWN,                 // No such verb
+    CMD_BAD_ARGS,                // Arguments do not match the schema
+    CMD_WRONG_MODE               // Not allowed right now (e.g. TARE while feeding)
+};
+
+class CommandDispatcher {
+public:
+    CommandDispatcher();
+
+    // Find the verb, check the mode and parse arguments (separators in `line`
+    // may be overwritten). spec is set whenever the verb was recognised.
+    CommandStatus parse(char* line, uint8_t mode, const CommandSpec*& spec, CommandArgs& args) const;
+
+    static const CommandSpec& getSpec(int index);
+    static int getCount();
+    static const char* modeName(uint8_t modes);
+    static const char* statusName(CommandStatus status);
+
+private:
+    // Perfect hash buckets: table index + 1 (0 = empty)
+    uint8_t buckets_[CMD_HASH_BUCKETS];
+
+    const CommandSpec* lookup(uint32_t hash, size_t length, const char* name) const;
+    static bool parseArgs(char* text, const char* schema, CommandArgs& args);
+};
@@ -0,0 +1,328 @@
+#include "SerialLink.h"
+#include <driver/uart.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+SerialLink::SerialLink()
+    : mode_(LINK_ASCII),
+      framesSent_(0),
+      baud_(SERIAL2_BAUD),
+      flowControl_(false),
+      current_(-1),
+      currentRemaining_(0),
+      currentStampUs_(0) {
+    uint8_t* data[LINK_PRIO_COUNT] = { urgentData_, normalData_, statusData_, bulkData_ };
+    size_t capacity[LINK_PRIO_COUNT] = { sizeof(urgentData_), sizeof(normalData_),
+                                         sizeof(statusData_), sizeof(bulkData_) };
+    for (int i = 0; i < LINK_PRIO_COUNT; i++) {
+        queues_[i].data = data[i];
+        queues_[i].capacity = capacity[i];
+        queues_[i].head = 0;
+        queues_[i].used = 0;
+        queues_[i].messages = 0;
+    }
+    memset(&txStats_, 0, sizeof(txStats_));
+}
+
+// ============================================================================
+// MODE
+// ============================================================================
+
+LinkMode SerialLink::getMode() const {
+    return mode_;
+}
+
+bool SerialLink::isBinary() const {
+    return mode_ == LINK_BINARY;
+}
+
+void SerialLink::setMode(LinkMode mode) {
+    if (mode != mode_) {
+        Serial.printf("[LINK] Framing: %s\n", mode == LINK_BINARY ? "BINARY" : "ASCII");
+    }
+    // Already-queued messages keep the framing they were encoded with
+    mode_ = mode;
+}
+
+// ============================================================================
+// LINE SPEED
+// ============================================================================
+
+void SerialLink::applyBaud(uint32_t baud, bool flowControl, bool discardPending) {
+    if (discardPending) {
+        // A peer that never asserts CTS would hold the UART forever
+        if (flowControl_) {
+            Serial2.setHwFlowCtrlMode(UART_HW_FLOWCTRL_DISABLE);
+            flowControl_ = false;
+        }
+        discardQueued();
+        waitTxDone(millis() + LINK_FLUSH_TIMEOUT_MS);
+    } else {
+        // Everything queued so far was meant for the old rate
+        flush();
+    }
+
+    Serial2.updateBaudRate(baud);
+    if (flowControl) {
+        Serial2.setPins(RXD2, TXD2, CTS2, RTS2);
+        Serial2.setHwFlowCtrlMode(UART_HW_FLOWCTRL_CTS_RTS, 64);
+    } else if (flowControl_) {
+        Serial2.setHwFlowCtrlMode(UART_HW_FLOWCTRL_DISABLE);
+    }
+
+    baud_ = baud;
+    flowControl_ = flowControl;
+    Serial.printf("[LINK] Serial2 at %lu baud%s\n", baud, flowControl ? " with RTS/CTS" : "");
+}
+
+uint32_t SerialLink::getBaud() const {
+    return baud_;
+}
+
+bool SerialLink::hasFlowControl() const {
+    return flowControl_;
+}
+
+// ============================================================================
+// SENDING
+// ============================================================================
+
+bool SerialLink::sendLine(const char* line, LinkPriority priority) {
+    size_t len = strlen(line);
+
+    if (mode_ == LINK_ASCII) {
+        uint8_t buffer[BinaryFrame::MAX_ENCODED + 2];
+        if (len + 2 > sizeof(buffer)) {
+            Serial.printf("[LINK] Line too long (%u bytes) - dropped\n", len);
+            return false;
+        }
+        memcpy(buffer, line, len);
+        buffer[len] = '\r';
+        buffer[len + 1] = '\n';
+        return enqueue(priority, buffer, len + 2);
+    }
+
+    if (len > BinaryFrame::MAX_PAYLOAD) {
+        Serial.printf("[LINK] Line too long for a frame (%u bytes) - dropped\n", len);
+        return false;
+    }
+    return sendFrame(MSG_TEXT, line, len, priority);
+}
+
+bool SerialLink::sendFrame(uint8_t type, const void* payload, size_t len, LinkPriority priority) {
+    if (mode_ != LINK_BINARY) {
+        return false;
+    }
+
+    uint8_t frame[BinaryFrame::MAX_ENCODED];
+    size_t frameLen = BinaryFrame::encode(type, payload, len, frame);
+    if (frameLen == 0 || !enqueue(priority, frame, frameLen)) {
+        return false;
+    }
+    framesSent_++;
+    return true;
+}
+
+bool SerialLink::canQueue(LinkPriority priority, size_t bytes) const {
+    const TxQueue& queue = queues_[priority];
+    return queue.used + RECORD_HEADER + bytes <= queue.capacity;
+}
+
+bool SerialLink::hasWaitingStatus() const {
+    size_t sending = (current_ == LINK_PRIO_STATUS) ? 1 : 0;
+    return queues_[LINK_PRIO_STATUS].messages > sending;
+}
+
+// ============================================================================
+// QUEUE
+// ============================================================================
+
+bool SerialLink::enqueue(LinkPriority priority, const uint8_t* bytes, size_t len) {
+    if (priority == LINK_PRIO_STATUS) {
+        dropQueuedStatus();  // Only the newest status is worth sending
+    }
+
+    TxQueue& queue = queues_[priority];
+    if (queue.used + RECORD_HEADER + len > queue.capacity) {
+        txStats_.dropped++;
+        Serial.printf("[LINK] TX queue %d full - message dropped\n", priority);
+        return false;
+    }
+
+    uint8_t header[RECORD_HEADER];
+    uint16_t recordLen = len;
+    uint32_t stamp = micros();
+    memcpy(header, &recordLen, sizeof(recordLen));
+    memcpy(header + sizeof(recordLen), &stamp, sizeof(stamp));
+
+    // Copy header then body into the ring (each may wrap)
+    const uint8_t* parts[2] = { header, bytes };
+    size_t sizes[2] = { RECORD_HEADER, len };
+    for (int p = 0; p < 2; p++) {
+        size_t tail = (queue.head + queue.used) % queue.capacity;
+        size_t first = min(sizes[p], queue.capacity - tail);
+        memcpy(queue.data + tail, parts[p], first);
+        memcpy(queue.data, parts[p] + first, sizes[p] - first);
+        queue.used += sizes[p];
+    }
+    queue.messages++;
+
+    txStats_.queued++;
+    size_t depth = totalDepth();
+    if (depth > txStats_.peakDepthBytes) {
+        txStats_.peakDepthBytes = depth;
+    }
+
+    // Start sending right away if the UART has room
+    pump();
+    return true;
+}
+
+void SerialLink::dropQueuedStatus() {
+    TxQueue& queue = queues_[LINK_PRIO_STATUS];
+    bool sending = (current_ == LINK_PRIO_STATUS);
+
+    // Keep the message being written (its remaining bytes sit at the head)
+    size_t keep = sending ? currentRemaining_ : 0;
+    size_t keepMessages = sending ? 1 : 0;
+    if (queue.messages > keepMessages) {
+        txStats_.coalesced += queue.messages - keepMessages;
+        queue.used = keep;
+        queue.messages = keepMessages;
+        if (!sending) {
+            queue.head = 0;
+        }
+    }
+}
+
+void SerialLink::popBytes(TxQueue& queue, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        out[i] = queue.data[queue.head];
+        queue.head = (queue.head + 1) % queue.capacity;
+    }
+    queue.used -= len;
+}
+
+size_t SerialLink::totalDepth() const {
+    size_t depth = 0;
+    for (int i = 0; i < LINK_PRIO_COUNT; i++) {
+        depth += queues_[i].used;
+    }
+    return depth;
+}
+
+// ============================================================================
+// DRAIN
+// ============================================================================
+
+void SerialLink::pump() {
+    while (true) {
+        // Pick the next message only once the UART can take bytes, so anything
+        // more urgent that arrives meanwhile still goes first
+        int room = Serial2.availableForWrite();
+        if (room <= 0) {
+            return;
+        }
+
+        if (current_ < 0) {
+            // Highest-priority queue with a waiting message
+            for (int i = 0; i < LINK_PRIO_COUNT; i++) {
+                if (queues_[i].messages > 0) {
+                    current_ = i;
+                    break;
+                }
+            }
+            if (current_ < 0) {
+                return;
+            }
+
+            uint8_t header[RECORD_HEADER];
+            uint16_t recordLen;
+            popBytes(queues_[current_], header, RECORD_HEADER);
+            memcpy(&recordLen, header, sizeof(recordLen));
+            memcpy(&currentStampUs_, header + sizeof(recordLen), sizeof(currentStampUs_));
+            currentRemaining_ = recordLen;
+        }
+
+        // Write straight from the ring (contiguous part only, rest next pass)
+        TxQueue& queue = queues_[current_];
+        size_t n = min(currentRemaining_, min((size_t)room, queue.capacity - queue.head));
+        Serial2.write(queue.data + queue.head, n);
+        queue.head = (queue.head + n) % queue.capacity;
+        queue.used -= n;
+        currentRemaining_ -= n;
+
+        if (currentRemaining_ == 0) {
+            finishMessage();
+        }
+    }
+}
+
+void SerialLink::finishMessage() {
+    TxQueue& queue = queues_[current_];
+    queue.messages--;
+    if (queue.used == 0) {
+        queue.head = 0;  // Keep records contiguous when idle
+    }
+    current_ = -1;
+
+    uint32_t latency = micros() - currentStampUs_;
+    txStats_.sent++;
+    txStats_.lastLatencyUs = latency;
+    txStats_.avgLatencyUs = txStats_.sent == 1 ? latency
+                          : txStats_.avgLatencyUs + ((int32_t)(latency - txStats_.avgLatencyUs) >> 3);
+    if (latency > txStats_.maxLatencyUs) {
+        txStats_.maxLatencyUs = latency;
+    }
+}
+
+bool SerialLink::flush() {
+    unsigned long deadline = millis() + LINK_FLUSH_TIMEOUT_MS;
+    while (current_ >= 0 || totalDepth() > 0) {
+        if ((long)(millis() - deadline) >= 0) {
+            Serial.printf("[LINK] TX stalled (%u bytes queued) - discarding\n", totalDepth());
+            discardQueued();
+            return false;
+        }
+        pump();
+        delay(1);
+    }
+    return waitTxDone(deadline);
+}
+
+bool SerialLink::waitTxDone(unsigned long deadline) {
+    // Driver ring + FIFO; bounded, unlike Serial2.flush()
+    long remaining = (long)(deadline - millis());
+    if (uart_wait_tx_done(UART_NUM_2, pdMS_TO_TICKS(remaining > 0 ? remaining : 0)) != ESP_OK) {
+        Serial.println("[LINK] UART TX did not drain in time");
+        return false;
+    }
+    return true;
+}
+
+void SerialLink::discardQueued() {
+    for (int i = 0; i < LINK_PRIO_COUNT; i++) {
+        txStats_.dropped += queues_[i].messages;
+        queues_[i].head = 0;
+        queues_[i].used = 0;
+        queues_[i].messages = 0;
+    }
+    current_ = -1;
+    currentRemaining_ = 0;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+SerialTxStats SerialLink::getTxStats() const {
+    SerialTxStats stats = txStats_;
+    stats.depthBytes = totalDepth();
+    return stats;
+}
+
+uint32_t SerialLink::getFramesSent() const {
+    return framesSent_;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <Arduino.h>
+#include "BinaryFrame.h"
+#include "../config/Config.h"
+#include "../config/TimingConfig.h"
+
+// ============================================================================
+// SERIAL LINK (Serial2 framing)
+// ============================================================================
+// Owns the wire format to the WiFi ESP. The link starts in ASCII (one text
+// line per message) and switches to binary framing only when the WiFi ESP asks:
+//   WiFi ESP: LINK:BINARY       -> Feeder: LINK:BINARY_OK (ASCII), then binary both ways
+//   WiFi ESP: LINK:ASCII        -> Feeder: LINK:ASCII_OK, then ASCII both ways
+// Binary frames are COBS + CRC16 (see BinaryFrame) with a one-byte message type;
+// status, logs, faults and schedule replies use the compact payloads below and
+// every other message travels as MSG_TEXT (its ASCII line, without newline).
+// The link falls back to ASCII after LINK_BINARY_MAX_ERRORS bad frames in a row,
+// and OTA forces ASCII (SerialOTAReceiver speaks raw lines).
+// The baud rate (and optional RTS/CTS) is negotiated by SerialProtocol with
+// LINK:BAUD:<rate>[:RTSCTS]; SerialLink only applies it to the UART.
+// All Serial2 output goes through a per-priority queue: messages are encoded
+// when queued and pump() tops up the UART driver's TX ring (drained by its
+// interrupt) with only as many bytes as it can take, so senders never block.
+
+enum LinkMode {
+    LINK_ASCII,
+    LINK_BINARY
+};
+
+// Message type IDs (first byte of every binary frame)
+enum LinkMessageType {
+    // Feeder -> WiFi ESP
+    MSG_STATUS          = 0x01,  // LinkStatusPayload (keyframe)
+    MSG_LOG             = 0x02,  // LinkLogPayload
+    MSG_FAULT           = 0x03,  // LinkFaultPayload + name (no terminator)
+    MSG_SCHEDULE_HASH   = 0x04,  // u32 hash
+    MSG_SCHEDULE_ACK    = 0x05,  // LinkScheduleAckPayload
+    MSG_SCHEDULE_NACK   = 0x06,  // u32 id + reason (no terminator)
+    MSG_STATUS_DELTA    = 0x07,  // u16 seq + u16 StatusField mask + changed values in bit order
+    MSG_FEED_PROGRESS   = 0x08,  // LinkFeedProgressPayload
+
+    // WiFi ESP -> Feeder
+    MSG_SCHEDULES_CHUNK = 0x10,  // u8 flags (LINK_CHUNK_*) + part of the SCHEDULES JSON
+    MSG_SCHEDULE_UPSERT = 0x11,  // LinkScheduleUpsertPayload
+    MSG_SCHEDULE_DELETE = 0x12,  // u32 id
+
+    // Either direction
+    MSG_TEXT            = 0x7F   // Any ASCII protocol line
+};
+
+#define LINK_CHUNK_FIRST 0x01
+#define LINK_CHUNK_LAST  0x02
+
+// Fixed-layout payloads (packed, little-endian)
+struct __attribute__((packed)) LinkStatusPayload {
+    uint16_t seq;                // Shared with MSG_STATUS_DELTA
+    uint8_t flags;               // bit0 isFeeding
+    uint8_t activeFaults;
+    uint8_t lastFeedComplete;
+    int32_t foodLevelG;          // grams
+    int16_t humidityX10;         // % x 10
+    int16_t temperatureX10;      // °C x 10
+    uint32_t waterFlowCl;        // centilitres
+    uint32_t linkBaud;
+    uint16_t linkErrors;         // Framing/parity + bad frames since boot (saturating)
+    uint16_t linkRetries;        // Failed baud negotiations + error fallbacks (saturating)
+};
+
+struct __attribute__((packed)) LinkLogPayload {
+    char timestamp[19];          // "YYYY-MM-DDTHH:MM:SS" (no terminator)
+    int32_t weightG;             // grams dispensed
+    uint8_t trigger;             // FeedingTrigger
+    uint16_t cycles;
+    uint32_t durationMs;
+    uint8_t senseDutyPct;
+    uint16_t senseEdges;
+};
+
+struct __attribute__((packed)) LinkFeedProgressPayload {
+    uint8_t state;               // FeedingState
+    uint8_t trigger;             // FeedingTrigger
+    uint8_t result;              // FeedingResult (0 while feeding)
+    int32_t dispensedG;
+    int32_t targetG;
+    uint16_t cycles;
+    uint32_t elapsedMs;
+};
+
+struct __attribute__((packed)) LinkFaultPayload {
+    uint32_t timestamp;          // millis() when raised
+    uint8_t code;
+    int32_t valueX100;
+};
+
+struct __attribute__((packed)) LinkScheduleAckPayload {
+    uint32_t id;
+    uint32_t entryHash;          // 0 after a delete
+    uint32_t tableHash;
+};
+
+struct __attribute__((packed)) LinkScheduleUpsertPayload {
+    uint32_t id;
+    uint16_t minuteOfDay;
+    uint8_t daysOfWeek;
+    uint16_t amountGrams;
+    uint8_t enabled;
+};
+
+// Transmit priority (lower value drains first; a started message is always finished)
+enum LinkPriority {
+    LINK_PRIO_URGENT,    // Faults, schedule hash/ACK/NACK, link control, OTA replies
+    LINK_PRIO_NORMAL,    // Feeding logs, command replies, schedule digest
+    LINK_PRIO_STATUS,    // Periodic status - a newer status replaces one still queued
+    LINK_PRIO_BULK,      // Diagnostic dumps (schedule status)
+    LINK_PRIO_COUNT
+};
+
+// Transmit counters (GET_LINK_STATS)
+struct SerialTxStats {
+    uint32_t queued;             // Messages accepted
+    uint32_t sent;               // Messages fully handed to the UART
+    uint32_t dropped;            // Rejected because their queue was full
+    uint32_t coalesced;          // Status messages replaced before they were sent
+    uint32_t depthBytes;         // Bytes waiting now (all queues)
+    uint32_t peakDepthBytes;
+    uint32_t lastLatencyUs;      // Enqueue -> last byte written to the UART driver
+    uint32_t avgLatencyUs;       // EMA (1/8)
+    uint32_t maxLatencyUs;
+};
+
+class SerialLink {
+public:
+    SerialLink();
+
+    LinkMode getMode() const;
+    bool isBinary() const;
+    void setMode(LinkMode mode);
+
+    // Queue one protocol line: CRLF-terminated in ASCII, MSG_TEXT frame in binary
+    // (false = dropped, queue full)
+    bool sendLine(const char* line, LinkPriority priority = LINK_PRIO_NORMAL);
+
+    // Queue a typed frame (binary mode only - callers send their ASCII form otherwise)
+    bool sendFrame(uint8_t type, const void* payload, size_t len,
+                   LinkPriority priority = LINK_PRIO_NORMAL);
+
+    // True if a message of `bytes` (encoded) fits in the queue right now (paced senders)
+    bool canQueue(LinkPriority priority, size_t bytes) const;
+
+    // True if a status is queued but not started - the next status will replace it
+    bool hasWaitingStatus() const;
+
+    // Move queued bytes into the UART without blocking (call every loop)
+    void pump();
+
+    // Block until everything queued has left the UART (OTA hand-over / reboot / baud change only);
+    // gives up after LINK_FLUSH_TIMEOUT_MS (e.g. CTS never asserted) and discards what is left
+    bool flush();
+
+    // Drop every queued message (the one half-written included)
+    void discardQueued();
+
+    // Drain the queue at the old rate, then switch the UART (and RTS/CTS on CTS2/RTS2).
+    // discardPending: the old rate has failed - turn flow control off and drop the
+    // queue instead of draining it (only bytes already in the driver go out)
+    void applyBaud(uint32_t baud, bool flowControl, bool discardPending = false);
+    uint32_t getBaud() const;
+    bool hasFlowControl() const;
+
+    SerialTxStats getTxStats() const;
+
+    // Frames sent since boot
+    uint32_t getFramesSent() const;
+
+private:
+    // Byte ring per priority holding [len:u16][enqueueUs:u32][bytes] records
+    struct TxQueue {
+        uint8_t* data;
+        size_t capacity;
+        size_t head;             // Oldest byte
+        size_t used;
+        size_t messages;
+    };
+    static const size_t RECORD_HEADER = 6;
+
+    LinkMode mode_;
+    uint32_t framesSent_;
+    uint32_t baud_;
+    bool flowControl_;
+
+    uint8_t urgentData_[SERIAL_TX_URGENT_BYTES];
+    uint8_t normalData_[SERIAL_TX_NORMAL_BYTES];
+    uint8_t statusData_[SERIAL_TX_STATUS_BYTES];
+    uint8_t bulkData_[SERIAL_TX_BULK_BYTES];
+    TxQueue queues_[LINK_PRIO_COUNT];
+
+    // Message being written (its bytes stay at the head of its queue until done)
+    int current_;                // Queue index, -1 = none
+    size_t currentRemaining_;
+    uint32_t currentStampUs_;
+
+    SerialTxStats txStats_;
+
+    bool enqueue(LinkPriority priority, const uint8_t* bytes, size_t len);
+    void dropQueuedStatus();
+    void finishMessage();
+    void popBytes(TxQueue& queue, uint8_t* out, size_t len);
+    size_t totalDepth() const;
+    bool waitTxDone(unsigned long deadline);
+};
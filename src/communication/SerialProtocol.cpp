@@ -3,6 +3,21 @@
 #include "../scheduling/ScheduleManager.h"
 #include "../feeding/FeedingStateMachine.h"
 #include "../faults/FaultManager.h"
+#include "SerialLink.h"
+#include "../config/TimingConfig.h"
+#include "../config/Config.h"
+#include "../config/Version.h"
+
+// Prefix of a full schedule sync - the JSON after it is streamed, not buffered
+#define SCHEDULES_PREFIX "SCHEDULES:"
+#define SCHEDULES_PREFIX_LEN 10
+
+// Raw ASCII line that recovers a peer which restarted while the link was binary
+#define LINK_ASCII_ESCAPE "LINK:ASCII"
+#define LINK_ASCII_ESCAPE_LEN 10
+
+// Static members
+SerialProtocol* SerialProtocol::instance_ = nullptr;
 
 // ============================================================================
 // CONSTRUCTOR
@@ -13,10 +28,30 @@ SerialProtocol::SerialProtocol()
       scheduleManager_(nullptr),
       feedingMachine_(nullptr),
       faultManager_(nullptr),
+      link_(nullptr),
       nameCallback_(nullptr),
       commandCallback_(nullptr),
-      rxIndex_(0) {
+      rxIndex_(0),
+      streamingSchedules_(false),
+      lastStreamByteTime_(0),
+      chunkPos_(0),
+      chunkLen_(0),
+      discarding_(false),
+      released_(false),
+      asciiEscapeMatch_(0),
+      baudVerifying_(false),
+      baudChangeTime_(0),
+      errorWindowStart_(0),
+      errorWindowBase_(0),
+      rateBytes_(0),
+      rateLines_(0),
+      rateWindowStart_(0),
+      uartOverruns_(0),
+      uartErrors_(0) {
     rxBuffer_[0] = '\0';
+    memset(&rxStats_, 0, sizeof(rxStats_));
+    memset(&speedStats_, 0, sizeof(speedStats_));
+    instance_ = this;
 }
 
 // ============================================================================
@@ -31,6 +66,14 @@ void SerialProtocol::begin(RTCManager* rtcManager,
     scheduleManager_ = scheduleManager;
     feedingMachine_ = feedingMachine;
     faultManager_ = faultManager;
+
+    // Count UART overruns / line errors (callback runs in the driver's event task)
+    Serial2.onReceiveError(onReceiveError);
+    rateWindowStart_ = millis();
+}
+
+void SerialProtocol::setLink(SerialLink* link) {
+    link_ = link;
 }
 
 void SerialProtocol::setNameUpdateCallback(NameUpdateCallback callback) {
@@ -46,56 +89,530 @@ void SerialProtocol::setCommandCallback(CommandCallback callback) {
 // ============================================================================
 
 void SerialProtocol::processIncoming() {
-    while (Serial2.available()) {
-        char c = Serial2.read();
+    // Sender went quiet mid-document - drop the partial sync
+    if (streamingSchedules_ && millis() - lastStreamByteTime_ >= SCHEDULE_STREAM_TIMEOUT_MS) {
+        streamingSchedules_ = false;
+        if (scheduleManager_) scheduleManager_->abortStreamSync();
+    }
+
+    updateRates();
+    checkLinkSpeed();
+
+    // Drain the UART in chunks and handle every complete line, within the tick budget
+    // (bytes not yet processed stay in rxChunk_ for the next call)
+    unsigned long start = micros();
+    while (micros() - start < SERIAL_RX_BUDGET_US) {
+        if (chunkPos_ == chunkLen_) {
+            int available = Serial2.available();
+            if (available <= 0) {
+                break;
+            }
+            chunkLen_ = Serial2.read(rxChunk_, min((size_t)available, RX_CHUNK_SIZE));
+            chunkPos_ = 0;
+            rxStats_.bytes += chunkLen_;
+            rateBytes_ += chunkLen_;
+            if (chunkLen_ == 0) {
+                break;
+            }
+        }
+
+        // Budget is checked again after each complete line or frame
+        // (mode is re-read per byte - a LINK: reply switches mid-chunk)
+        while (chunkPos_ < chunkLen_) {
+            uint8_t b = rxChunk_[chunkPos_++];
+            bool done = (link_ && link_->isBinary()) ? processFrameByte(b) : processByte(b);
+            if (done) {
+                break;
+            }
+        }
+
+        // A handler gave Serial2 to OTA: its next bytes are not ours to parse.
+        // What is left of this chunk predates OTA_READY, which startOTA() drains anyway
+        if (released_) {
+            released_ = false;
+            chunkPos_ = chunkLen_;
+            rxIndex_ = 0;
+            discarding_ = false;
+            decoder_.reset();
+            return;
+        }
+    }
+}
+
+void SerialProtocol::releaseSerial() {
+    released_ = true;
+}
 
+bool SerialProtocol::processByte(char c) {
+    if (streamingSchedules_) {
+        lastStreamByteTime_ = millis();
         if (c == '\n' || c == '\r') {
-            if (rxIndex_ == 0) continue;  // Skip empty lines
+            streamingSchedules_ = false;
+            // Note: ScheduleManager sends the hash confirmation itself
+            if (scheduleManager_) scheduleManager_->endStreamSync();
+            countLine();
+            return true;
+        }
+        if (scheduleManager_) scheduleManager_->streamSyncByte(c);
+        return false;
+    }
+
+    if (discarding_) {
+        // Rest of an overlong (or unhandled) line
+        if (c == '\n') discarding_ = false;
+        return false;
+    }
+
+    if (c == '\n' || c == '\r') {
+        if (rxIndex_ == 0) return false;  // Skip empty lines
+
+        rxBuffer_[rxIndex_] = '\0';
 
-            rxBuffer_[rxIndex_] = '\0';
+        // Trim trailing whitespace
+        while (rxIndex_ > 0 && (rxBuffer_[rxIndex_ - 1] == ' ' || rxBuffer_[rxIndex_ - 1] == '\t')) {
+            rxBuffer_[--rxIndex_] = '\0';
+        }
+
+        Serial.printf("[SERIAL] RX: '%s'\n", rxBuffer_);
+        handleLine();
+        rxIndex_ = 0;
+        countLine();
+        return true;
+    }
 
-            // Trim trailing whitespace
-            while (rxIndex_ > 0 && (rxBuffer_[rxIndex_ - 1] == ' ' || rxBuffer_[rxIndex_ - 1] == '\t')) {
-                rxBuffer_[--rxIndex_] = '\0';
+    // Append character if buffer has space
+    if (rxIndex_ < MAX_MESSAGE_LEN - 1) {
+        rxBuffer_[rxIndex_++] = c;
+
+        // Full schedule sync: hand the rest of the line to the stream parser
+        if (rxIndex_ == SCHEDULES_PREFIX_LEN &&
+            strncmp(rxBuffer_, SCHEDULES_PREFIX, SCHEDULES_PREFIX_LEN) == 0) {
+            Serial.println("[SERIAL] RX: SCHEDULES (streaming)");
+            rxIndex_ = 0;
+            if (scheduleManager_) {
+                scheduleManager_->beginStreamSync();
+                streamingSchedules_ = true;
+                lastStreamByteTime_ = millis();
+            } else {
+                discarding_ = true;  // Nobody to parse it - discard the document
             }
+        }
+    } else {
+        // Buffer overflow - discard entire message
+        Serial.println("[SERIAL] Message too long - discarding");
+        rxIndex_ = 0;
+        discarding_ = true;
+        rxStats_.discarded++;
+    }
+    return false;
+}
+
+void SerialProtocol::handleLine() {
+    const CommandSpec* spec;
+    CommandArgs args;
+    uint8_t mode = (feedingMachine_ && feedingMachine_->isFeeding()) ? CMD_MODE_FEEDING : CMD_MODE_IDLE;
+    CommandStatus status = dispatcher_.parse(rxBuffer_, mode, spec, args);
+
+    if (status != CMD_OK) {
+        rejectCommand(status, spec, args);
+        return;
+    }
+
+    switch (spec->id) {
+        case CMD_CLEAR_FAULTS:
+            Serial.println("[SERIAL] Clearing all faults");
+            if (faultManager_) faultManager_->clearAllFaults();
+            break;
+
+        case CMD_GET_SCHEDULE_STATUS:
+            if (scheduleManager_) scheduleManager_->sendScheduleStatus();
+            break;
+
+        case CMD_GET_LINK_STATS:
+            sendLinkStats();
+            break;
+
+        case CMD_TIME:
+            Serial.println("[SERIAL] Syncing time");
+            handleTime(args.text);
+            break;
+
+        case CMD_NAME:
+            Serial.println("[SERIAL] Updating name");
+            handleName(args.text ? args.text : "");
+            break;
 
-            Serial.printf("[SERIAL] RX: '%s'\n", rxBuffer_);
+        case CMD_SCHEDULES:
+            // Only reaches here inside a MSG_TEXT frame - the ASCII link streams it
+            if (scheduleManager_) scheduleManager_->parseSchedules(args.text ? args.text : "");
+            break;
 
-            // Parse message type and data
-            if (strncmp(rxBuffer_, "SCHEDULES:", 10) == 0) {
-                Serial.println("[SERIAL] Parsing schedules");
-                handleSchedules(rxBuffer_ + 10);
+        case CMD_SCHEDULE_UPSERT:
+            handleScheduleUpsert(args);
+            break;
+
+        case CMD_SCHEDULE_DELETE:
+            if (scheduleManager_) scheduleManager_->deleteSchedule(args.num[0]);
+            break;
+
+        case CMD_SCHEDULE_DIGEST:
+            if (scheduleManager_) scheduleManager_->sendDigest();
+            break;
+
+        case CMD_LINK_BINARY:
+        case CMD_LINK_ASCII:
+        case CMD_LINK_BAUD:
+        case CMD_LINK_TEST:
+            handleLink(spec->id, args);
+            break;
+
+        case CMD_HELP:
+            sendCapabilities();
+            break;
+
+        default:
+            // Feeding / hardware commands (FEED_NOW, TARE, OTA_START, ...)
+            if (commandCallback_) {
+                commandCallback_(spec->id, args);
             }
-            else if (strncmp(rxBuffer_, "TIME:", 5) == 0) {
-                Serial.println("[SERIAL] Syncing time");
-                handleTime(rxBuffer_ + 5);
+            break;
+    }
+}
+
+void SerialProtocol::rejectCommand(CommandStatus status, const CommandSpec* spec, const CommandArgs& args) {
+    // An undecodable upsert is still answered the way the sync protocol expects
+    if (status == CMD_BAD_ARGS && spec && spec->id == CMD_SCHEDULE_UPSERT && scheduleManager_) {
+        scheduleManager_->rejectSync(args.count > 0 ? args.num[0] : 0, "format");
+        return;
+    }
+    if (status == CMD_BAD_ARGS && spec && spec->id == CMD_LINK_BAUD) {
+        sendLine("LINK:BAUD_ERROR", LINK_PRIO_URGENT);  // The WiFi ESP keeps the old rate
+        return;
+    }
+
+    char verb[24];
+    if (spec) {
+        snprintf(verb, sizeof(verb), "%s", spec->name);
+    } else {
+        snprintf(verb, sizeof(verb), "%.*s", (int)strcspn(rxBuffer_, ":"), rxBuffer_);
+    }
+
+    char reply[48];
+    snprintf(reply, sizeof(reply), "CMD_ERROR:%s,%s", verb, CommandDispatcher::statusName(status));
+    sendLine(reply, LINK_PRIO_NORMAL);
+    Serial.printf("[SERIAL] %s\n", reply);
+}
+
+void SerialProtocol::sendCapabilities() {
+    // CAPS:BEGIN,<count>,<version> / CAPS:<verb>,<schema>,<modes> ... / CAPS:END
+    char line[64];
+    snprintf(line, sizeof(line), "CAPS:BEGIN,%d,%s", CommandDispatcher::getCount(), FIRMWARE_VERSION);
+    sendLine(line, LINK_PRIO_NORMAL);
+    for (int i = 0; i < CommandDispatcher::getCount(); i++) {
+        const CommandSpec& spec = CommandDispatcher::getSpec(i);
+        snprintf(line, sizeof(line), "CAPS:%s,%s,%s", spec.name, spec.args, CommandDispatcher::modeName(spec.modes));
+        sendLine(line, LINK_PRIO_NORMAL);
+    }
+    sendLine("CAPS:END", LINK_PRIO_NORMAL);
+}
+
+// ============================================================================
+// BINARY FRAME PROCESSING
+// ============================================================================
+
+bool SerialProtocol::processFrameByte(uint8_t b) {
+    // A peer that restarted in ASCII cannot frame - accept its raw LINK:ASCII line
+    if (asciiEscapeMatch_ == LINK_ASCII_ESCAPE_LEN && (b == '\n' || b == '\r')) {
+        asciiEscapeMatch_ = 0;
+        fallBackToAscii("peer requested ASCII");
+        sendLine("LINK:ASCII_OK", LINK_PRIO_URGENT);
+        countLine();
+        return true;
+    }
+    if (asciiEscapeMatch_ < LINK_ASCII_ESCAPE_LEN && b == (uint8_t)LINK_ASCII_ESCAPE[asciiEscapeMatch_]) {
+        asciiEscapeMatch_++;
+    } else {
+        asciiEscapeMatch_ = (b == 'L') ? 1 : 0;
+    }
+
+    uint32_t errorsBefore = decoder_.getErrorCount();
+    if (decoder_.feed(b)) {
+        rxStats_.frames++;
+        rateLines_++;
+        handleFrame();
+        return true;
+    }
+
+    if (decoder_.getErrorCount() != errorsBefore) {
+        Serial.printf("[SERIAL] Bad frame dropped (%u in a row)\n", decoder_.getConsecutiveErrors());
+        if (decoder_.getConsecutiveErrors() >= LINK_BINARY_MAX_ERRORS) {
+            fallBackToAscii("too many bad frames");
+            sendLine("LINK:ASCII", LINK_PRIO_URGENT);  // Tell the WiFi ESP to follow
+        }
+        return true;
+    }
+    return false;
+}
+
+void SerialProtocol::handleFrame() {
+    const uint8_t* data = decoder_.payload();
+    size_t len = decoder_.length();
+
+    switch (decoder_.type()) {
+        case MSG_TEXT:
+            // An ASCII protocol line in a frame
+            if (len >= MAX_MESSAGE_LEN) {
+                rxStats_.discarded++;
+                break;
             }
-            else if (strncmp(rxBuffer_, "NAME:", 5) == 0) {
-                Serial.println("[SERIAL] Updating name");
-                handleName(rxBuffer_ + 5);
+            memcpy(rxBuffer_, data, len);
+            rxBuffer_[len] = '\0';
+            Serial.printf("[SERIAL] RX frame: '%s'\n", rxBuffer_);
+            handleLine();
+            break;
+
+        case MSG_SCHEDULES_CHUNK:
+            handleScheduleChunk(data, len);
+            break;
+
+        case MSG_SCHEDULE_UPSERT: {
+            if (!scheduleManager_) break;
+            LinkScheduleUpsertPayload upsert;
+            if (len != sizeof(upsert)) {
+                uint32_t id = 0;
+                if (len >= sizeof(id)) memcpy(&id, data, sizeof(id));
+                scheduleManager_->rejectSync(id, "format");
+                break;
             }
-            else {
-                Serial.println("[SERIAL] Processing as command");
-                handleCommand(rxBuffer_);
+            memcpy(&upsert, data, sizeof(upsert));
+            if (upsert.minuteOfDay >= 1440) {
+                scheduleManager_->rejectSync(upsert.id, "format");
+                break;
             }
-
-            rxIndex_ = 0;
-            return;
+            scheduleManager_->upsertSchedule(upsert.id, upsert.minuteOfDay, upsert.daysOfWeek,
+                                             upsert.amountGrams, upsert.enabled != 0);
+            break;
         }
 
-        // Append character if buffer has space
-        if (rxIndex_ < MAX_MESSAGE_LEN - 1) {
-            rxBuffer_[rxIndex_++] = c;
-        } else {
-            // Buffer overflow - discard entire message
-            Serial.println("[SERIAL] Message too long - discarding");
-            rxIndex_ = 0;
-            // Drain remaining bytes until newline
-            while (Serial2.available()) {
-                if (Serial2.read() == '\n') break;
-            }
-            return;
+        case MSG_SCHEDULE_DELETE: {
+            if (!scheduleManager_ || len != sizeof(uint32_t)) break;
+            uint32_t id;
+            memcpy(&id, data, sizeof(id));
+            scheduleManager_->deleteSchedule(id);
+            break;
         }
+
+        default:
+            Serial.printf("[SERIAL] Unknown frame type 0x%02X (%u bytes)\n", decoder_.type(), len);
+            break;
+    }
+}
+
+void SerialProtocol::handleScheduleChunk(const uint8_t* data, size_t len) {
+    if (!scheduleManager_ || len < 1) {
+        return;
+    }
+
+    // flags byte, then the next slice of the SCHEDULES JSON document
+    uint8_t flags = data[0];
+    if (flags & LINK_CHUNK_FIRST) {
+        if (streamingSchedules_) scheduleManager_->abortStreamSync();
+        Serial.println("[SERIAL] RX: SCHEDULES (framed)");
+        scheduleManager_->beginStreamSync();
+        streamingSchedules_ = true;
+    }
+    if (!streamingSchedules_) {
+        return;  // Missed the first chunk - wait for the next document
+    }
+
+    lastStreamByteTime_ = millis();
+    for (size_t i = 1; i < len; i++) {
+        scheduleManager_->streamSyncByte((char)data[i]);
+    }
+
+    if (flags & LINK_CHUNK_LAST) {
+        streamingSchedules_ = false;
+        scheduleManager_->endStreamSync();  // Sends the hash confirmation
+    }
+}
+
+void SerialProtocol::fallBackToAscii(const char* reason) {
+    Serial.printf("[SERIAL] Link back to ASCII: %s\n", reason);
+    if (streamingSchedules_) {
+        streamingSchedules_ = false;
+        if (scheduleManager_) scheduleManager_->abortStreamSync();
+    }
+    rxIndex_ = 0;
+    discarding_ = false;
+    link_->setMode(LINK_ASCII);
+}
+
+// ============================================================================
+// LINE SPEED
+// ============================================================================
+
+void SerialProtocol::changeBaud(uint32_t baud, bool flowControl) {
+    speedStats_.negotiations++;
+
+    // Acknowledge at the old rate (applyBaud drains it first), then switch
+    char reply[40];
+    snprintf(reply, sizeof(reply), "LINK:BAUD_OK:%lu%s", baud, flowControl ? ":RTSCTS" : "");
+    sendLine(reply, LINK_PRIO_URGENT);
+    link_->applyBaud(baud, flowControl);
+
+    // Anything still in the chunk was sampled at the old rate
+    chunkPos_ = chunkLen_;
+    rxIndex_ = 0;
+    discarding_ = false;
+    decoder_.reset();
+
+    baudVerifying_ = true;
+    baudChangeTime_ = millis();
+    errorWindowStart_ = baudChangeTime_;
+    errorWindowBase_ = lineErrorCount();
+}
+
+void SerialProtocol::revertBaud(const char* reason) {
+    Serial.printf("[SERIAL] Link back to %d baud: %s\n", SERIAL2_BAUD, reason);
+    baudVerifying_ = false;
+
+    // Common ground is the boot configuration: default rate, no flow control, ASCII
+    if (link_->isBinary()) {
+        fallBackToAscii("baud fallback");
+    }
+    link_->applyBaud(SERIAL2_BAUD, false, true);  // Queue was meant for the failed rate
+    chunkPos_ = chunkLen_;
+    rxIndex_ = 0;
+    discarding_ = false;
+    decoder_.reset();
+    errorWindowStart_ = millis();
+    errorWindowBase_ = lineErrorCount();
+
+    sendLine("LINK:BAUD_FALLBACK", LINK_PRIO_URGENT);
+}
+
+void SerialProtocol::checkLinkSpeed() {
+    if (!link_) {
+        return;
+    }
+
+    unsigned long now = millis();
+
+    // The WiFi ESP must prove the new rate promptly
+    if (baudVerifying_ && now - baudChangeTime_ >= LINK_BAUD_VERIFY_TIMEOUT_MS) {
+        speedStats_.failures++;
+        revertBaud("no test pattern");
+        return;
+    }
+
+    if (link_->getBaud() == SERIAL2_BAUD) {
+        return;  // Nothing slower to fall back to
+    }
+
+    // Framing/parity errors and bad frames mean the rate is not holding up
+    uint32_t errors = lineErrorCount();
+    if (errors - errorWindowBase_ >= LINK_BAUD_MAX_ERRORS) {
+        speedStats_.fallbacks++;
+        revertBaud("too many line errors");
+        return;
+    }
+    if (now - errorWindowStart_ >= LINK_BAUD_ERROR_WINDOW_MS) {
+        errorWindowStart_ = now;
+        errorWindowBase_ = errors;
+    }
+}
+
+uint32_t SerialProtocol::lineErrorCount() const {
+    return uartErrors_ + decoder_.getErrorCount();
+}
+
+LinkSpeedStats SerialProtocol::getSpeedStats() const {
+    return speedStats_;
+}
+
+// ============================================================================
+// RECEIVE STATISTICS
+// ============================================================================
+
+void SerialProtocol::onReceiveError(hardwareSerial_error_t error) {
+    // Runs in the UART driver's event task
+    SerialProtocol* self = instance_;
+    if (!self) return;
+
+    switch (error) {
+        case UART_BUFFER_FULL_ERROR:
+        case UART_FIFO_OVF_ERROR:
+            self->uartOverruns_++;  // Bytes were lost
+            break;
+        case UART_BREAK_ERROR:
+        case UART_FRAME_ERROR:
+        case UART_PARITY_ERROR:
+            self->uartErrors_++;
+            break;
+        default:
+            break;
+    }
+}
+
+void SerialProtocol::countLine() {
+    rxStats_.lines++;
+    rateLines_++;
+}
+
+void SerialProtocol::updateRates() {
+    unsigned long now = millis();
+    unsigned long elapsed = now - rateWindowStart_;
+    if (elapsed < 1000) {
+        return;
+    }
+
+    rxStats_.bytesPerSec = rateBytes_ * 1000UL / elapsed;
+    rxStats_.linesPerSec = rateLines_ * 1000UL / elapsed;
+    rateBytes_ = 0;
+    rateLines_ = 0;
+    rateWindowStart_ = now;
+}
+
+SerialRxStats SerialProtocol::getRxStats() const {
+    SerialRxStats stats = rxStats_;
+    stats.overruns = uartOverruns_;
+    stats.errors = uartErrors_;
+    stats.frameErrors = decoder_.getErrorCount();
+    return stats;
+}
+
+void SerialProtocol::sendLinkStats() {
+    SerialRxStats stats = getRxStats();
+    char message[256];
+    snprintf(message, sizeof(message),
+             "LINK_STATS:{\"mode\":\"%s\",\"rxBytes\":%lu,\"rxLines\":%lu,\"rxBps\":%lu,\"rxLps\":%lu,"
+             "\"overruns\":%lu,\"errors\":%lu,\"discarded\":%lu,\"frames\":%lu,\"frameErrors\":%lu}",
+             (link_ && link_->isBinary()) ? "binary" : "ascii",
+             (unsigned long)stats.bytes, (unsigned long)stats.lines,
+             (unsigned long)stats.bytesPerSec, (unsigned long)stats.linesPerSec,
+             (unsigned long)stats.overruns, (unsigned long)stats.errors,
+             (unsigned long)stats.discarded, (unsigned long)stats.frames,
+             (unsigned long)stats.frameErrors);
+    sendLine(message, LINK_PRIO_NORMAL);
+    Serial.printf("[SERIAL] %s\n", message);
+
+    if (!link_) {
+        return;
+    }
+    SerialTxStats tx = link_->getTxStats();
+    snprintf(message, sizeof(message),
+             "LINK_TX_STATS:{\"queued\":%lu,\"sent\":%lu,\"dropped\":%lu,\"coalesced\":%lu,"
+             "\"depth\":%lu,\"peakDepth\":%lu,\"latUs\":%lu,\"avgLatUs\":%lu,\"maxLatUs\":%lu}",
+             (unsigned long)tx.queued, (unsigned long)tx.sent, (unsigned long)tx.dropped,
+             (unsigned long)tx.coalesced, (unsigned long)tx.depthBytes, (unsigned long)tx.peakDepthBytes,
+             (unsigned long)tx.lastLatencyUs, (unsigned long)tx.avgLatencyUs, (unsigned long)tx.maxLatencyUs);
+    sendLine(message, LINK_PRIO_NORMAL);
+    Serial.printf("[SERIAL] %s\n", message);
+}
+
+void SerialProtocol::sendLine(const char* line, LinkPriority priority) {
+    if (link_) {
+        link_->sendLine(line, priority);
     }
 }
 
@@ -103,14 +620,22 @@ void SerialProtocol::processIncoming() {
 // MESSAGE HANDLERS
 // ============================================================================
 
-void SerialProtocol::handleSchedules(const char* jsonData) {
+void SerialProtocol::handleScheduleUpsert(const CommandArgs& args) {
     if (!scheduleManager_) {
         return;
     }
 
-    // Parse and cache schedules
-    scheduleManager_->parseSchedules(jsonData);
-    // Note: ScheduleManager will send hash confirmation automatically
+    // <id>,<HH:MM>,<daysMask>,<grams>[,<enabled>] - parsed by the dispatcher
+    uint32_t id = args.num[0];
+    uint32_t grams = args.num[3];
+    bool enabled = (args.count < 5) || args.num[4] != 0;
+    if (grams > 65535) {
+        Serial.printf("[SERIAL] Bad SCHEDULE_UPSERT amount for id=%lu: %lu\n", id, grams);
+        scheduleManager_->rejectSync(id, "format");
+        return;
+    }
+
+    scheduleManager_->upsertSchedule(id, args.num[1], args.num[2], grams, enabled);
 }
 
 void SerialProtocol::handleTime(const char* timeString) {
@@ -118,28 +643,75 @@ void SerialProtocol::handleTime(const char* timeString) {
         return;
     }
 
+    // Line transit time: "TIME:" + stamp + '\n' at 10 bits per byte - the stamp
+    // was taken before the first byte left the WiFi ESP
+    uint32_t baud = link_ ? link_->getBaud() : SERIAL2_BAUD;
+    uint32_t linkDelayUs = (uint32_t)((strlen(timeString) + 6) * 10ULL * 1000000ULL / baud);
+
     // Sync RTC from WiFi ESP (NTP synced time)
-    rtcManager_->syncFromString(timeString);
+    if (rtcManager_->syncFromString(timeString, linkDelayUs) && scheduleManager_) {
+        scheduleManager_->reanchor();  // Next-due timer was based on the old time
+    }
 }
 
-void SerialProtocol::handleName(const char* name) {
-    // Notify callback (for LCD display update)
-    if (nameCallback_) {
-        nameCallback_(name);
+void SerialProtocol::handleLink(CommandId id, const CommandArgs& args) {
+    if (!link_) {
+        sendLine("LINK:UNSUPPORTED", LINK_PRIO_URGENT);
+        return;
     }
-}
 
-void SerialProtocol::handleCommand(const char* command) {
-    // Handle built-in commands
-    if (strcmp(command, "CLEAR_FAULTS") == 0) {
-        if (faultManager_) {
-            faultManager_->clearAllFaults();
+    // Reply in the current mode/rate, then switch - the WiFi ESP switches on the reply
+    switch (id) {
+        case CMD_LINK_BINARY:
+            sendLine("LINK:BINARY_OK", LINK_PRIO_URGENT);
+            decoder_.reset();
+            asciiEscapeMatch_ = 0;
+            link_->setMode(LINK_BINARY);
+            break;
+
+        case CMD_LINK_ASCII:
+            sendLine("LINK:ASCII_OK", LINK_PRIO_URGENT);
+            fallBackToAscii("peer requested ASCII");
+            break;
+
+        case CMD_LINK_BAUD: {
+            // <rate>[:RTSCTS]
+            uint32_t baud = args.num[0];
+            bool flowControl = (args.count > 1);
+            if ((flowControl && strcmp(args.text, "RTSCTS") != 0) ||
+                baud < SERIAL2_BAUD || baud > LINK_BAUD_MAX) {
+                Serial.printf("[SERIAL] Rejected LINK:BAUD %lu\n", baud);
+                sendLine("LINK:BAUD_ERROR", LINK_PRIO_URGENT);
+                return;
+            }
+            changeBaud(baud, flowControl);
+            break;
         }
+
+        case CMD_LINK_TEST:
+            if (strcmp(args.text, LINK_TEST_PATTERN) == 0) {
+                sendLine("LINK:TEST_OK", LINK_PRIO_URGENT);
+                if (baudVerifying_) {
+                    baudVerifying_ = false;
+                    speedStats_.verified++;
+                    Serial.printf("[SERIAL] Link verified at %lu baud\n", link_->getBaud());
+                }
+            } else if (baudVerifying_) {
+                speedStats_.failures++;
+                revertBaud("test pattern mismatch");
+            } else {
+                sendLine("LINK:TEST_FAIL", LINK_PRIO_URGENT);
+            }
+            break;
+
+        default:
+            break;
     }
-    else {
-        // Pass to callback for handling (FEED_NOW, TARE, RESET_FLOW, etc.)
-        if (commandCallback_) {
-            commandCallback_(command);
-        }
+}
+
+void SerialProtocol::handleName(const char* name) {
+    // Notify callback (for LCD display update)
+    if (nameCallback_) {
+        nameCallback_(name);
     }
 }
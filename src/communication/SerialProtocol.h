@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Arduino.h>
+#include "SerialLink.h"
+#include "CommandDispatcher.h"
 
 // Forward declarations
 class RTCManager;
@@ -8,12 +10,41 @@ class ScheduleManager;
 class FeedingStateMachine;
 class FaultManager;
 
+// Receive counters (GET_LINK_STATS)
+struct SerialRxStats {
+    uint32_t bytes;          // Total bytes received
+    uint32_t lines;          // Complete lines handled
+    uint32_t overruns;       // UART FIFO / RX buffer overflows (bytes lost)
+    uint32_t errors;         // Framing / parity / break errors
+    uint32_t discarded;      // Lines dropped for exceeding MAX_MESSAGE_LEN
+    uint32_t frames;         // Valid binary frames handled
+    uint32_t frameErrors;    // Binary frames dropped (COBS / CRC / length)
+    uint32_t bytesPerSec;    // Over the last ~1 s window
+    uint32_t linesPerSec;
+};
+
+// Line speed negotiation counters (reported in status)
+struct LinkSpeedStats {
+    uint32_t negotiations;   // LINK:BAUD requests accepted
+    uint32_t verified;       // Test pattern received at the new rate
+    uint32_t failures;       // Test pattern missing or wrong - reverted to SERIAL2_BAUD
+    uint32_t fallbacks;      // Too many line errors at a negotiated rate - reverted
+};
+
 // ============================================================================
 // SERIAL PROTOCOL (Serial2 ↔ WiFi ESP)
 // ============================================================================
 // Handles bidirectional communication with WiFi ESP
-// RX: SCHEDULES, TIME, NAME, Commands (FEED_NOW, TARE, etc.)
+// RX: every verb is listed once in CommandDispatcher's table (HELP returns it);
+//     protocol verbs are handled here, feeding/hardware verbs by the command callback
 // TX: Status updates (handled by StatusReporter)
+// RX drains the UART in chunks and handles every complete line per call,
+// bounded by SERIAL_RX_BUDGET_US; leftover bytes carry over to the next call
+// In binary link mode (LINK:BINARY, see SerialLink) bytes go to the frame
+// decoder instead; MSG_TEXT frames are handled exactly like received lines
+// Line speed: LINK:BAUD:<rate>[:RTSCTS] is acknowledged at the old rate, then
+// both sides switch and the WiFi ESP proves the link with LINK:TEST:<pattern>;
+// a missing/wrong pattern or repeated line errors revert to SERIAL2_BAUD
 
 class SerialProtocol {
 public:
@@ -25,15 +56,29 @@ public:
                FeedingStateMachine* feedingMachine,
                FaultManager* faultManager);
 
+    // Serial2 link (framing mode and replies); without it the link stays ASCII
+    void setLink(SerialLink* link);
+
     // Process incoming Serial2 data (call from main loop)
     void processIncoming();
 
+    // Serial2 RX now belongs to someone else (OTA): processIncoming() stops after
+    // the current line and drops the rest of its chunk (call from the command callback)
+    void releaseSerial();
+
+    // Receive counters and rates
+    SerialRxStats getRxStats() const;
+
+    // Baud negotiation counters
+    LinkSpeedStats getSpeedStats() const;
+
     // Set device name callback
     typedef void (*NameUpdateCallback)(const char* name);
     void setNameUpdateCallback(NameUpdateCallback callback);
 
-    // Set command callback (for FEED_NOW, TARE, etc.)
-    typedef void (*CommandCallback)(const char* command);
+    // Set command callback (for FEED_NOW, TARE, etc.) - arguments already parsed
+    // and the system mode already checked against the command table
+    typedef void (*CommandCallback)(CommandId command, const CommandArgs& args);
     void setCommandCallback(CommandCallback callback);
 
 private:
@@ -41,18 +86,76 @@ private:
     ScheduleManager* scheduleManager_;
     FeedingStateMachine* feedingMachine_;
     FaultManager* faultManager_;
+    SerialLink* link_;
 
     NameUpdateCallback nameCallback_;
     CommandCallback commandCallback_;
+    CommandDispatcher dispatcher_;
 
     // Receive buffer (fixed size to avoid heap fragmentation from String)
-    static const size_t MAX_MESSAGE_LEN = 8192;
+    // SCHEDULES: documents bypass it and are streamed into ScheduleManager
+    static const size_t MAX_MESSAGE_LEN = 256;
     char rxBuffer_[MAX_MESSAGE_LEN];
     size_t rxIndex_;
 
+    // Full schedule sync in progress (bytes go to the stream parser until end of line)
+    bool streamingSchedules_;
+    unsigned long lastStreamByteTime_;
+
+    // Bulk receive chunk (drained from the UART; processed up to chunkPos_)
+    static const size_t RX_CHUNK_SIZE = 128;
+    uint8_t rxChunk_[RX_CHUNK_SIZE];
+    size_t chunkPos_;
+    size_t chunkLen_;
+    bool discarding_;               // Dropping the rest of a line until '\n'
+    bool released_;                 // releaseSerial() called by a handler
+
+    // Binary framing
+    BinaryFrameDecoder decoder_;
+    uint8_t asciiEscapeMatch_;      // Progress through a raw "LINK:ASCII" line while binary
+
+    // Line speed negotiation
+    bool baudVerifying_;            // Waiting for LINK:TEST at the new rate
+    unsigned long baudChangeTime_;
+    unsigned long errorWindowStart_;
+    uint32_t errorWindowBase_;      // Line errors counted when the window started
+    LinkSpeedStats speedStats_;
+
+    // Statistics
+    SerialRxStats rxStats_;
+    uint32_t rateBytes_;
+    uint32_t rateLines_;
+    unsigned long rateWindowStart_;
+    volatile uint32_t uartOverruns_;  // Updated from the UART event task
+    volatile uint32_t uartErrors_;
+    static SerialProtocol* instance_;
+    static void onReceiveError(hardwareSerial_error_t error);
+
+    // Feed one byte; true when it completed a line (budget is checked between lines)
+    bool processByte(char c);
+    void handleLine();
+    void countLine();
+    void updateRates();
+    void sendLinkStats();
+    void sendLine(const char* line, LinkPriority priority);
+
+    // Binary mode receive
+    bool processFrameByte(uint8_t b);
+    void handleFrame();
+    void handleScheduleChunk(const uint8_t* data, size_t len);
+    void fallBackToAscii(const char* reason);
+
+    // Line speed
+    void checkLinkSpeed();
+    void changeBaud(uint32_t baud, bool flowControl);
+    void revertBaud(const char* reason);
+    uint32_t lineErrorCount() const;
+
     // Message handlers
-    void handleSchedules(const char* jsonData);
+    void rejectCommand(CommandStatus status, const CommandSpec* spec, const CommandArgs& args);
+    void sendCapabilities();
+    void handleScheduleUpsert(const CommandArgs& args);
     void handleTime(const char* timeString);
     void handleName(const char* name);
-    void handleCommand(const char* command);
+    void handleLink(CommandId id, const CommandArgs& args);
 };
@@ -1,13 +1,61 @@
 #include "StatusReporter.h"
+#include "SerialLink.h"
 #include "../config/FeedingConfig.h"
 
+// ============================================================================
+// FIELD TABLE
+// ============================================================================
+
+struct StatusFieldSpec {
+    const char* name;            // JSON key
+    float scale;                 // Reported resolution (value * scale, rounded)
+    uint8_t decimals;            // JSON decimals (0 = integer)
+    uint8_t bytes;               // Size in MSG_STATUS_DELTA (little-endian)
+    float deadband;              // Change from last sent before it is reported (0 = any change)
+    float emaAlpha;              // Weight of a new reading (1 = raw)
+    uint32_t minIntervalMs;
+    uint32_t maxIntervalMs;      // Sub-deadband change still sent after this (0 = never)
+};
+
+// StatusField order
+static const StatusFieldSpec FIELD_SPECS[STATUS_FIELD_COUNT] = {
+    { "isFeeding",        1.0f,    0, 1, 0.0f,                     1.0f,                   0,                        0 },
+    { "foodLevel",        1000.0f, 3, 4, STATUS_FOOD_LEVEL_DELTA,  STATUS_FOOD_LEVEL_EMA,  STATUS_FOOD_LEVEL_MIN_MS, STATUS_FOOD_LEVEL_MAX_MS },
+    { "humidity",         10.0f,   1, 2, STATUS_HUMIDITY_DELTA,    STATUS_HUMIDITY_EMA,    STATUS_CLIMATE_MIN_MS,    STATUS_CLIMATE_MAX_MS },
+    { "temperature",      10.0f,   1, 2, STATUS_TEMPERATURE_DELTA, STATUS_TEMPERATURE_EMA, STATUS_CLIMATE_MIN_MS,    STATUS_CLIMATE_MAX_MS },
+    { "waterFlow",        100.0f,  2, 4, STATUS_WATER_FLOW_DELTA,  STATUS_WATER_FLOW_EMA,  STATUS_WATER_FLOW_MIN_MS, STATUS_WATER_FLOW_MAX_MS },
+    { "activeFaults",     1.0f,    0, 1, 0.0f,                     1.0f,                   0,                        0 },
+    { "lastFeedComplete", 1.0f,    0, 1, 0.0f,                     1.0f,                   0,                        0 },
+    { "linkBaud",         1.0f,    0, 4, 0.0f,                     1.0f,                   0,                        0 },
+    { "linkErrors",       1.0f,    0, 2, 0.0f,                     1.0f,                   STATUS_LINK_MIN_MS,       0 },
+    { "linkRetries",      1.0f,    0, 2, 0.0f,                     1.0f,                   STATUS_LINK_MIN_MS,       0 },
+};
+
+#define STATUS_ALL_FIELDS ((uint16_t)((1 << STATUS_FIELD_COUNT) - 1))
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 
-StatusReporter::StatusReporter() {
-    previousStatus_.lastUpdateTime = 0;
-    lastSentIsFeeding_ = false;
+StatusReporter::StatusReporter()
+    : link_(nullptr),
+      readingsValid_(false),
+      isFeeding_(false),
+      seq_(0),
+      keyframeRequested_(true),  // First status after boot is a keyframe
+      lastKeyframeTime_(0),
+      queuedMask_(0),
+      queuedKeyframe_(false) {
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        fields_[i].value = 0;
+        fields_[i].primed = false;
+        fields_[i].sent = 0;
+        fields_[i].sentAt = 0;
+    }
+}
+
+void StatusReporter::setLink(SerialLink* link) {
+    link_ = link;
 }
 
 // ============================================================================
@@ -15,16 +63,54 @@ StatusReporter::StatusReporter() {
 // ============================================================================
 
 void StatusReporter::updateReadings(const SensorReadings& readings) {
-    currentReadings_ = readings;
+    readingsValid_ = readings.valid;
+    smoothField(STATUS_FIELD_FOOD_LEVEL, readings.foodLevel);
+    smoothField(STATUS_FIELD_HUMIDITY, readings.humidity);
+    smoothField(STATUS_FIELD_TEMPERATURE, readings.temperature);
+    smoothField(STATUS_FIELD_WATER_FLOW, max(readings.waterFlow, 0.0f));
+    setField(STATUS_FIELD_IS_FEEDING, (readingsValid_ && isFeeding_) ? 1 : 0);
 }
 
 void StatusReporter::updateFeedingState(bool isFeeding, FeedingResult lastResult) {
-    previousStatus_.isFeeding = isFeeding;
-    previousStatus_.lastFeedComplete = lastResult;
+    isFeeding_ = isFeeding;
+    setField(STATUS_FIELD_IS_FEEDING, (readingsValid_ && isFeeding_) ? 1 : 0);
+    setField(STATUS_FIELD_LAST_FEED_COMPLETE, lastResult);
 }
 
 void StatusReporter::updateFaults(uint8_t activeFaults) {
-    previousStatus_.activeFaults = activeFaults;
+    setField(STATUS_FIELD_ACTIVE_FAULTS, activeFaults);
+}
+
+void StatusReporter::updateLinkHealth(uint32_t baud, uint32_t errors, uint32_t retries) {
+    // Counters saturate at 16 bits as in the binary payload
+    setField(STATUS_FIELD_LINK_BAUD, baud);
+    setField(STATUS_FIELD_LINK_ERRORS, min<uint32_t>(errors, 0xFFFF));
+    setField(STATUS_FIELD_LINK_RETRIES, min<uint32_t>(retries, 0xFFFF));
+}
+
+void StatusReporter::requestKeyframe() {
+    keyframeRequested_ = true;
+}
+
+void StatusReporter::setField(StatusField field, float value) {
+    fields_[field].value = value;
+    fields_[field].primed = true;
+}
+
+void StatusReporter::smoothField(StatusField field, float sample) {
+    FieldState& state = fields_[field];
+    const StatusFieldSpec& spec = FIELD_SPECS[field];
+
+    // A step far beyond the deadband is a real change (refill, sensor back online)
+    if (!state.primed || fabsf(sample - state.value) >= spec.deadband * STATUS_EMA_SNAP_FACTOR) {
+        setField(field, sample);
+        return;
+    }
+    state.value += spec.emaAlpha * (sample - state.value);
+}
+
+int32_t StatusReporter::reported(int field) const {
+    return (int32_t)lroundf(fields_[field].value * FIELD_SPECS[field].scale);
 }
 
 // ============================================================================
@@ -32,82 +118,166 @@ void StatusReporter::updateFaults(uint8_t activeFaults) {
 // ============================================================================
 
 bool StatusReporter::shouldSendStatus() {
-    unsigned long now = millis();
+    return keyframeDue() || dueFields(false) != 0;
+}
 
-    // Always send if significant change
-    if (hasSignificantChange()) {
-        return true;
+void StatusReporter::sendStatus() {
+    if (keyframeDue()) {
+        send(STATUS_ALL_FIELDS, true);
+        return;
     }
 
-    // Heartbeat: send every 5 minutes even if no change
-    if (now - previousStatus_.lastUpdateTime >= STATUS_HEARTBEAT_INTERVAL) {
-        return true;
+    uint16_t mask = dueFields(false);
+    if (mask) {
+        send(mask, false);
+    }
+}
+
+void StatusReporter::forceSend() {
+    if (keyframeDue()) {
+        send(STATUS_ALL_FIELDS, true);
+        return;
     }
 
-    return false;
+    uint16_t mask = dueFields(true);
+    if (mask) {
+        send(mask, false);
+    }
 }
 
-void StatusReporter::sendStatus() {
-    // Build JSON status message
-    char message[256];
-    snprintf(message, sizeof(message),
-             "{\"isFeeding\":%s,\"foodLevel\":%.3f,\"humidity\":%.1f,\"temperature\":%.1f,\"waterFlow\":%.2f,\"activeFaults\":%d,\"lastFeedComplete\":%d}",
-             currentReadings_.valid && previousStatus_.isFeeding ? "true" : "false",
-             currentReadings_.foodLevel,
-             currentReadings_.humidity,
-             currentReadings_.temperature,
-             currentReadings_.waterFlow,
-             previousStatus_.activeFaults,
-             previousStatus_.lastFeedComplete);
+bool StatusReporter::keyframeDue() const {
+    return keyframeRequested_ || millis() - lastKeyframeTime_ >= STATUS_HEARTBEAT_INTERVAL;
+}
 
-    // Debug: Log what we're sending
-    Serial.printf("[STATUS] TX: %s\n", message);
+uint16_t StatusReporter::dueFields(bool ignoreMinInterval) const {
+    unsigned long now = millis();
+    uint16_t mask = 0;
 
-    // Send via Serial2
-    Serial2.println(message);
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        const FieldState& state = fields_[i];
+        const StatusFieldSpec& spec = FIELD_SPECS[i];
+        if (!state.primed || reported(i) == state.sent) {
+            continue;
+        }
 
-    // Update previous values
-    previousStatus_.foodLevel = currentReadings_.foodLevel;
-    previousStatus_.humidity = currentReadings_.humidity;
-    previousStatus_.temperature = currentReadings_.temperature;
-    previousStatus_.waterFlow = currentReadings_.waterFlow;
-    lastSentIsFeeding_ = previousStatus_.isFeeding;
-    previousStatus_.lastUpdateTime = millis();
-}
+        unsigned long elapsed = now - state.sentAt;
+        if (!ignoreMinInterval && elapsed < spec.minIntervalMs) {
+            continue;
+        }
 
-void StatusReporter::forceSend() {
-    sendStatus();
+        // Deadband is measured from the value last sent, so noise around one
+        // boundary cannot make the field flap
+        float lastSent = state.sent / spec.scale;
+        if (spec.deadband == 0 || fabsf(state.value - lastSent) >= spec.deadband ||
+            (spec.maxIntervalMs && elapsed >= spec.maxIntervalMs)) {
+            mask |= (1 << i);
+        }
+    }
+    return mask;
 }
 
-// ============================================================================
-// CHANGE DETECTION
-// ============================================================================
+void StatusReporter::send(uint16_t mask, bool keyframe) {
+    // A frame still waiting in the link is replaced by this one: carry its fields
+    // and reuse its seq so the WiFi ESP sees neither a gap nor lost values
+    if (link_ && link_->hasWaitingStatus()) {
+        mask |= queuedMask_;
+        keyframe = keyframe || queuedKeyframe_;
+    } else {
+        seq_++;
+    }
+    if (keyframe) {
+        mask = STATUS_ALL_FIELDS;
+    }
 
-bool StatusReporter::hasSignificantChange() {
-    // Check food level change
-    if (fabs(currentReadings_.foodLevel - previousStatus_.foodLevel) >= STATUS_FOOD_LEVEL_DELTA) {
-        return true;
+    if (link_ && link_->isBinary()) {
+        sendBinary(mask, keyframe);
+    } else {
+        sendJson(mask, keyframe);
     }
 
-    // Check humidity change
-    if (fabs(currentReadings_.humidity - previousStatus_.humidity) >= STATUS_HUMIDITY_DELTA) {
-        return true;
+    unsigned long now = millis();
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            fields_[i].sent = reported(i);
+            fields_[i].sentAt = now;
+        }
+    }
+    if (keyframe) {
+        keyframeRequested_ = false;
+        lastKeyframeTime_ = now;
     }
+    queuedMask_ = mask;
+    queuedKeyframe_ = keyframe;
+}
+
+void StatusReporter::sendBinary(uint16_t mask, bool keyframe) {
+    if (keyframe) {
+        LinkStatusPayload payload;
+        payload.seq = seq_;
+        payload.flags = reported(STATUS_FIELD_IS_FEEDING) ? 0x01 : 0x00;
+        payload.activeFaults = reported(STATUS_FIELD_ACTIVE_FAULTS);
+        payload.lastFeedComplete = reported(STATUS_FIELD_LAST_FEED_COMPLETE);
+        payload.foodLevelG = reported(STATUS_FIELD_FOOD_LEVEL);
+        payload.humidityX10 = reported(STATUS_FIELD_HUMIDITY);
+        payload.temperatureX10 = reported(STATUS_FIELD_TEMPERATURE);
+        payload.waterFlowCl = reported(STATUS_FIELD_WATER_FLOW);
+        payload.linkBaud = reported(STATUS_FIELD_LINK_BAUD);
+        payload.linkErrors = reported(STATUS_FIELD_LINK_ERRORS);
+        payload.linkRetries = reported(STATUS_FIELD_LINK_RETRIES);
 
-    // Check temperature change
-    if (fabs(currentReadings_.temperature - previousStatus_.temperature) >= STATUS_TEMPERATURE_DELTA) {
-        return true;
+        Serial.printf("[STATUS] TX keyframe #%u: food=%ldg faults=%d\n",
+                      seq_, (long)payload.foodLevelG, payload.activeFaults);
+        link_->sendFrame(MSG_STATUS, &payload, sizeof(payload), LINK_PRIO_STATUS);
+        return;
     }
 
-    // Check water flow change
-    if (fabs(currentReadings_.waterFlow - previousStatus_.waterFlow) >= STATUS_WATER_FLOW_DELTA) {
-        return true;
+    // seq, mask, then each present field in bit order (ESP32 is little-endian)
+    uint8_t payload[4 + STATUS_FIELD_COUNT * 4];
+    size_t len = 0;
+    memcpy(payload + len, &seq_, sizeof(seq_));
+    len += sizeof(seq_);
+    memcpy(payload + len, &mask, sizeof(mask));
+    len += sizeof(mask);
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            int32_t value = reported(i);
+            memcpy(payload + len, &value, FIELD_SPECS[i].bytes);
+            len += FIELD_SPECS[i].bytes;
+        }
     }
 
-    // Check feeding state change
-    if (previousStatus_.isFeeding != lastSentIsFeeding_) {
-        return true;
+    Serial.printf("[STATUS] TX delta #%u: mask=0x%03X (%u bytes)\n", seq_, mask, len);
+    link_->sendFrame(MSG_STATUS_DELTA, payload, len, LINK_PRIO_STATUS);
+}
+
+void StatusReporter::sendJson(uint16_t mask, bool keyframe) {
+    char message[256];
+    size_t len = snprintf(message, sizeof(message), "{\"seq\":%u%s", seq_, keyframe ? ",\"key\":true" : "");
+
+    for (int i = 0; i < STATUS_FIELD_COUNT && len < sizeof(message); i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        const StatusFieldSpec& spec = FIELD_SPECS[i];
+        int32_t value = reported(i);
+        if (i == STATUS_FIELD_IS_FEEDING) {
+            len += snprintf(message + len, sizeof(message) - len, ",\"%s\":%s", spec.name, value ? "true" : "false");
+        } else if (spec.decimals > 0) {
+            len += snprintf(message + len, sizeof(message) - len, ",\"%s\":%.*f", spec.name, spec.decimals, value / spec.scale);
+        } else {
+            len += snprintf(message + len, sizeof(message) - len, ",\"%s\":%ld", spec.name, (long)value);
+        }
+    }
+    if (len < sizeof(message) - 1) {
+        message[len++] = '}';
+        message[len] = '\0';
     }
 
-    return false;
+    // Debug: Log what we're sending
+    Serial.printf("[STATUS] TX: %s\n", message);
+
+    // Queued on the link; replaces a status still waiting to go out
+    if (link_) {
+        link_->sendLine(message, LINK_PRIO_STATUS);
+    }
 }
@@ -6,18 +6,43 @@
 // Forward declarations
 class FeedingStateMachine;
 class FaultManager;
+class SerialLink;
 
 // ============================================================================
 // STATUS REPORTER
 // ============================================================================
 // Delta-based status reporting to WiFi ESP
-// Only sends status if significant changes detected
+// Frames carry a sequence number and only the fields that changed; a full
+// keyframe goes out on the heartbeat, on STATUS_KEYFRAME, and first after boot.
+// Each field has its own deadband (on an EMA-smoothed value) and min/max interval.
+//   ASCII:  {"seq":12,"key":true,"isFeeding":false,...}   keyframe (all fields)
+//           {"seq":13,"foodLevel":12.350}                 delta
+//   Binary: MSG_STATUS keyframe, MSG_STATUS_DELTA (StatusField bit mask)
+// A seq gap means a frame was lost - the WiFi ESP should ask for a keyframe.
+
+// Field order = JSON order = MSG_STATUS_DELTA mask bit
+enum StatusField {
+    STATUS_FIELD_IS_FEEDING,
+    STATUS_FIELD_FOOD_LEVEL,
+    STATUS_FIELD_HUMIDITY,
+    STATUS_FIELD_TEMPERATURE,
+    STATUS_FIELD_WATER_FLOW,
+    STATUS_FIELD_ACTIVE_FAULTS,
+    STATUS_FIELD_LAST_FEED_COMPLETE,
+    STATUS_FIELD_LINK_BAUD,
+    STATUS_FIELD_LINK_ERRORS,
+    STATUS_FIELD_LINK_RETRIES,
+    STATUS_FIELD_COUNT
+};
 
 class StatusReporter {
 public:
     StatusReporter();
 
-    // Update sensor readings
+    // Route status through the Serial2 link (compact MSG_STATUS frames in binary mode)
+    void setLink(SerialLink* link);
+
+    // Update sensor readings (smoothed per field)
     void updateReadings(const SensorReadings& readings);
 
     // Update feeding state
@@ -26,20 +51,52 @@ public:
     // Update active faults
     void updateFaults(uint8_t activeFaults);
 
-    // Check if status should be sent (call every 10s)
+    // Update Serial2 link health (counters are rate-limited to STATUS_LINK_MIN_MS)
+    void updateLinkHealth(uint32_t baud, uint32_t errors, uint32_t retries);
+
+    // Check if status should be sent (call every STATUS_REPORT_INTERVAL_MS)
     bool shouldSendStatus();
 
-    // Send status to Serial2
+    // Send a keyframe if one is due, otherwise a delta of the fields that are due
     void sendStatus();
 
-    // Force send (heartbeat)
+    // Send changed fields now, ignoring their minimum intervals (faults, failed feeds)
     void forceSend();
 
+    // Send a full keyframe with the next status (STATUS_KEYFRAME / seq gap on the WiFi ESP)
+    void requestKeyframe();
+
 private:
-    SensorReadings currentReadings_;
-    PreviousStatus previousStatus_;
-    bool lastSentIsFeeding_;
+    struct FieldState {
+        float value;             // Latest (smoothed) value in field units
+        bool primed;             // value holds a reading
+        int32_t sent;            // Last sent value at reported resolution
+        unsigned long sentAt;    // millis() of the last send
+    };
+
+    SerialLink* link_;
+    FieldState fields_[STATUS_FIELD_COUNT];
+    bool readingsValid_;
+    bool isFeeding_;
+
+    uint16_t seq_;
+    bool keyframeRequested_;
+    unsigned long lastKeyframeTime_;
+
+    // Last frame queued - replaced (and merged into the next) if still waiting
+    uint16_t queuedMask_;
+    bool queuedKeyframe_;
+
+    void setField(StatusField field, float value);
+    void smoothField(StatusField field, float sample);
+    int32_t reported(int field) const;
+
+    bool keyframeDue() const;
+
+    // Fields whose change should be sent now
+    uint16_t dueFields(bool ignoreMinInterval) const;
 
-    // Check if any value changed significantly
-    bool hasSignificantChange();
+    void send(uint16_t mask, bool keyframe);
+    void sendBinary(uint16_t mask, bool keyframe);
+    void sendJson(uint16_t mask, bool keyframe);
 };
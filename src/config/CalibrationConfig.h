@@ -8,6 +8,22 @@
 #define SCALE_CALIBRATION_FACTOR 101.0f          // Calibration factor for HX711 (matches original code)
 #define SCALE_TARE_SAMPLES 20                    // Number of samples for tare (matches original code)
 #define SCALE_READ_SAMPLES 10                    // Number of samples for each reading (increased for noise filtering)
+#define SCALE_SAMPLE_BUFFER_SIZE 16              // Ring buffer of recent HX711 samples (must be >= SCALE_READ_SAMPLES)
+#define SCALE_STALE_TIMEOUT 1000                 // ms - no new HX711 sample for this long = sensor not responding
+
+// HX711 per-sample filter chain: Hampel spike rejector -> smoothing stage (EMA or Kalman)
+#define SCALE_FILTER_MODE WEIGHT_FILTER_KALMAN   // WEIGHT_FILTER_NONE / WEIGHT_FILTER_EMA / WEIGHT_FILTER_KALMAN
+#define SCALE_HAMPEL_WINDOW 5                    // Samples in median window (odd, max 9)
+#define SCALE_HAMPEL_THRESHOLD 3.0f              // Reject sample if |x - median| > threshold * 1.4826 * MAD
+#define SCALE_HAMPEL_MIN_SPREAD_G 5.0f           // g - MAD floor so a quiet scale doesn't reject real weight changes
+#define SCALE_EMA_ALPHA 0.3f                     // EMA weight of newest sample
+#define SCALE_KALMAN_PROCESS_NOISE_G 3.0f        // g - expected true weight change per sample (std dev)
+#define SCALE_KALMAN_MEASUREMENT_NOISE_G 8.0f    // g - HX711 + vibration noise per sample (std dev)
+
+// Scale-settled detection (rolling variance + slope over newest samples)
+#define SCALE_STABLE_WINDOW 3                    // Samples that must all be newer than the settle start
+#define SCALE_STABLE_MAX_STDDEV_G 4.0f           // g - max std dev across the window
+#define SCALE_STABLE_MAX_SLOPE_G 2.0f            // g per sample - max least-squares trend across the window
 
 // YF-S201 Water Flow Sensor Calibration
 #define FLOW_SENSOR_CALIBRATION 1046.0f          // Pulses per liter
@@ -18,3 +34,14 @@
 
 // RTC Configuration
 #define RTC_SYNC_TIMEOUT 5000                    // ms - max time to wait for RTC response
+#define RTC_VERIFY_INTERVAL 60000                // ms - re-read DS3231 to keep the cached clock on it
+#define RTC_ALIGN_TIMEOUT 1100                   // ms - max wait for a seconds rollover when anchoring
+#define RTC_SQW_TIMEOUT 1500                     // ms - no SQW edge for this long = esp_timer keeps time alone
+
+// RTC discipline (TIME: syncs) - local time = RTC + software offset, slewed between syncs
+#define RTC_STEP_THRESHOLD 1000                  // ms - sync offsets beyond this are stepped, smaller ones slewed
+#define RTC_SLEW_RATE_PPM 500.0f                 // Max slew rate (0.5 ms per second)
+#define RTC_DRIFT_RESOLUTION_PPM 2.0f            // Only estimate drift over intervals long enough for this resolution
+#define RTC_DRIFT_LEARN_ALPHA 0.3f               // EMA weight of each new drift measurement
+#define RTC_DRIFT_MAX_PPM 100.0f                 // Larger measured drift = bad sync, ignored
+#define RTC_SYNC_STAMP_UNCERTAINTY 5000          // us - TIME: stamp with milliseconds (without: +/-0.5 s)
@@ -16,6 +16,7 @@
 #define I2C_SDA 21
 #define I2C_SCL 22
 #define LCD_I2C_ADDRESS 0x27    // 16x2 LCD display
+#define RTC_SQW_PIN 27          // DS3231 SQW/INT, 1 Hz open-drain (falling edge = seconds rollover)
 
 // Temperature/Humidity Sensor
 #define DHT_PIN 4               // DHT22 data pin
@@ -27,7 +28,18 @@
 // Serial Communication with WiFi ESP
 #define RXD2 16                 // Serial2 RX (receives from WiFi ESP)
 #define TXD2 17                 // Serial2 TX (sends to WiFi ESP)
-#define SERIAL2_BAUD 115200     // Must match WiFi ESP
+#define RTS2 19                 // Serial2 RTS (used only when RTS/CTS is negotiated)
+#define CTS2 23                 // Serial2 CTS
+#define SERIAL2_BAUD 115200     // Boot / fallback rate - must match WiFi ESP
+#define LINK_BAUD_MAX 2000000   // Highest rate accepted by LINK:BAUD negotiation
+// Verification line after a baud change: runs of 0x55/0x2A/0x5A and mixed bits
+#define LINK_TEST_PATTERN "UUUU****ZZZZ0123456789:;<=>?@ABCDEF~~~~"
+#define LINK_BINARY_MAX_ERRORS 5  // Bad frames in a row before falling back to ASCII
+#define SERIAL2_TX_BUFFER 1024  // UART driver TX ring (interrupt-drained)
+#define SERIAL_TX_URGENT_BYTES 1024  // SerialLink queue sizes per priority
+#define SERIAL_TX_NORMAL_BYTES 2048
+#define SERIAL_TX_STATUS_BYTES 528   // Two max-size records (one sending, one waiting)
+#define SERIAL_TX_BULK_BYTES   1024
 
 // LCD Display Configuration
 #define LCD_COLS 16
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "FeedingConfig.h"
 
 // ============================================================================
 // CONSTANTS
@@ -13,17 +14,23 @@
 // DATA STRUCTURES
 // ============================================================================
 
-// Schedule Structure
+// Schedule flags
+#define SCHEDULE_FLAG_ENABLED 0x01
+
+// Schedule Structure (packed at ingest - no string handling on the check path)
+// 12 bytes, naturally aligned; persisted byte-for-byte (see ScheduleManager for layout version)
 struct Schedule {
-    char time[6];              // "HH:MM" format
-    uint8_t daysOfWeek;        // Bitmask: bit 0=Sunday, bit 1=Monday, ..., bit 6=Saturday
-    float amount;              // kg - amount to dispense
-    bool enabled;              // Is this schedule active
-    uint32_t lastExecutionDate; // YYYYMMDD format - tracks when this schedule last executed
-
-    Schedule() : daysOfWeek(0), amount(0.0f), enabled(false), lastExecutionDate(0) {
-        strcpy(time, "00:00");
-    }
+    uint32_t id;                // Stable id shared with the WiFi ESP (FNV-1a of its schedule key)
+    uint16_t minuteOfDay;       // 0-1439 (HH * 60 + MM)
+    uint16_t amountGrams;       // Amount to dispense
+    uint16_t lastExecutionDay;  // Day serial (unix time / 86400) of last execution, 0 = never
+    uint8_t daysOfWeek;         // Bitmask: bit 0=Sunday, bit 1=Monday, ..., bit 6=Saturday
+    uint8_t flags;              // SCHEDULE_FLAG_*
+
+    Schedule() : id(0), minuteOfDay(0), amountGrams(0), lastExecutionDay(0), daysOfWeek(0), flags(0) {}
+
+    bool isEnabled() const { return flags & SCHEDULE_FLAG_ENABLED; }
+    float amountKg() const { return amountGrams / 1000.0f; }
 };
 
 // Fault Codes (bitmask)
@@ -56,6 +63,7 @@ enum FeedingState {
     FEEDING_DISPENSING,     // Motor running, continuous (manual feed only)
     FEEDING_PULSING,        // Motor pulsing (one pulse cycle)
     FEEDING_SETTLING,       // Motor off, waiting for scale to stabilize before reading
+    FEEDING_CONTINUOUS,     // Motor running, weighing while dispensing (large scheduled feeds)
     FEEDING_FINISHING,      // Post-feed cleanup
     FEEDING_COOLDOWN_STATE  // Cooldown period
 };
@@ -73,29 +81,67 @@ enum FeedingResult {
     RESULT_SUCCESS = 1,     // Feeding completed successfully
     RESULT_LOW_LEVEL = 2,   // Low food level prevented feeding
     RESULT_TIMEOUT = 3,     // Feeding timed out
-    RESULT_ERROR = 4        // Other error
+    RESULT_ERROR = 4,       // Other error
+    RESULT_MOTOR_STALL = 5, // Motor sense fault (stall or relay/sense mismatch)
+    RESULT_NO_FLOW = 6      // Motor ran but dispense rate collapsed (bridged hopper / empty auger)
 };
 
-// Previous Status (for delta detection)
-struct PreviousStatus {
-    float foodLevel;
-    float humidity;
-    float temperature;
-    float waterFlow;
-    bool isFeeding;
-    uint8_t activeFaults;
-    uint8_t lastFeedComplete;
-    unsigned long lastUpdateTime;
-
-    PreviousStatus() :
-        foodLevel(0),
-        humidity(0),
-        temperature(0),
-        waterFlow(0),
-        isFeeding(false),
-        activeFaults(0),
-        lastFeedComplete(0),
-        lastUpdateTime(0) {}
+// Learned dispense model (persisted in NVS)
+struct DispenseModelState {
+    uint8_t version;           // Layout version (mismatch = discard)
+    float gramsPerMs;          // Learned dispense rate per ms of motor-on time (0 = not learned)
+    uint16_t rateSamples;      // Observations folded into gramsPerMs
+    float inflightG[FEEDING_INFLIGHT_BUCKETS];         // Learned overshoot after stop, per pulse-length bucket
+    uint8_t inflightSamples[FEEDING_INFLIGHT_BUCKETS]; // Observations per bucket (0 = use stop-early fallback)
+
+    static const uint8_t CURRENT_VERSION = 3;
+
+    DispenseModelState() : version(CURRENT_VERSION), gramsPerMs(0.0f), rateSamples(0) {
+        for (int i = 0; i < FEEDING_INFLIGHT_BUCKETS; i++) {
+            inflightG[i] = 0.0f;
+            inflightSamples[i] = 0;
+        }
+    }
+};
+
+// Completed feeding summary (for LOG messages)
+struct FeedingReport {
+    FeedingTrigger trigger;
+    FeedingResult result;
+    float amount;              // kg dispensed
+    uint16_t pulseCycles;      // Pulse/settle cycles used (0 for continuous manual feed)
+    unsigned long durationMs;  // Start to motor stop
+    uint8_t senseDutyPct;      // Motor sense active time as % of relay-on time
+    uint16_t senseEdges;       // Motor sense transitions during the feed
+
+    FeedingReport() :
+        trigger(TRIGGER_NONE),
+        result(RESULT_NONE),
+        amount(0.0f),
+        pulseCycles(0),
+        durationMs(0),
+        senseDutyPct(0),
+        senseEdges(0) {}
+};
+
+// Live feed snapshot (FEED_PROGRESS while feeding, final one at finish)
+struct FeedingProgress {
+    FeedingState state;
+    FeedingTrigger trigger;
+    FeedingResult result;      // RESULT_NONE until the feed finished
+    float dispensed;           // kg - live (fast weight) while feeding, captured at finish; last good value on scale errors
+    float target;              // kg
+    uint16_t pulseCycles;
+    unsigned long elapsedMs;   // Since start (frozen at motor stop)
+
+    FeedingProgress() :
+        state(FEEDING_IDLE),
+        trigger(TRIGGER_NONE),
+        result(RESULT_NONE),
+        dispensed(0.0f),
+        target(0.0f),
+        pulseCycles(0),
+        elapsedMs(0) {}
 };
 
 // Sensor Readings
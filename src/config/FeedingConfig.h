@@ -23,17 +23,72 @@
 #define FEEDING_LONG_PULSE_ON_TIME 150           // ms - motor pulse when far from target (>70% remaining)
 #define FEEDING_SHORT_PULSE_ON_TIME 50           // ms - motor pulse when close to target
 #define FEEDING_PHASE_THRESHOLD 0.3f             // Switch to short pulses when 70% dispensed (30% remaining)
-#define FEEDING_SETTLE_TIME 400                  // ms - wait after motor off for scale to stabilize
-#define FEEDING_STOP_EARLY_FACTOR 0.85f          // Stop at 85% of target (in-flight food covers the rest)
+#define FEEDING_SETTLE_MAX_TIME 600              // ms - max wait after motor off if scale never reads stable
+#define FEEDING_STOP_EARLY_FACTOR 0.85f          // Stop at 85% of target until in-flight mass is learned (see below)
 #define FEEDING_FAST_READ_SAMPLES 3              // Fewer HX711 samples for faster reads during feeding
 #define MAX_SCHEDULES 150                        // Maximum cached schedules (18 schedules × 7 days = 126)
+#define SCHEDULE_HASH_CRC32 0                    // SCHEDULE_HASH digest: 1 = ROM CRC-32, 0 = djb2 (WiFi ESP must match)
 
-// Status Reporting Deltas (send status only if changed by these amounts)
+// Predictive pulse sizing: learned grams-per-ms of motor-on time sizes each pulse
+#define FEEDING_PREDICTIVE_PULSES 1              // 1 = size pulses from learned rate, 0 = long/short two-step scheme
+#define FEEDING_PULSE_REMAINING_FRACTION 0.6f    // Each pulse aims to cover this fraction of the remaining amount
+#define FEEDING_MIN_PULSE_ON_TIME 40             // ms - shortest predictive pulse (motor spin-up floor)
+#define FEEDING_MAX_PULSE_ON_TIME 3000           // ms - longest predictive pulse
+#define FEEDING_RATE_LEARN_ALPHA 0.3f            // EMA weight of each new rate observation
+#define FEEDING_RATE_MIN_SAMPLE_G 2.0f           // g - ignore cycles that moved less than this (noise)
+
+// In-flight compensation: stop point = target - learned in-flight mass for the last pulse length
+// FEEDING_STOP_EARLY_FACTOR is only the fallback until a pulse-length bucket has been learned
+#define FEEDING_INFLIGHT_BUCKETS 5               // Pulse-length buckets: <=75, <=200, <=600, <=MAX_PULSE, continuous run
+#define FEEDING_INFLIGHT_LEARN_ALPHA 0.3f        // EMA weight of each new in-flight observation
+#define FEEDING_INFLIGHT_MAX_FRACTION 0.3f       // Never predict more than 30% of target in flight
+#define FEEDING_INFLIGHT_MEASURE_DELAY 2000      // ms into cooldown to take the fully-settled final reading
+
+// Continuous weigh-while-dispensing (scheduled feeds): motor runs while a Kalman estimator
+// tracks dispensed mass; stops when estimate + predicted in-flight mass reaches target
+#define FEEDING_CONTINUOUS_MODE 1                // 1 = enable for large feeds, 0 = always pulse-and-weigh
+#define FEEDING_CONTINUOUS_MIN_AMOUNT 0.5f       // kg - smallest scheduled target that runs continuously
+#define FEEDING_EST_NOISE_MOTOR_ON_G 40.0f       // g - reading std dev while auger vibrates the scale
+#define FEEDING_EST_NOISE_MOTOR_OFF_G 8.0f       // g - reading std dev with motor stopped
+#define FEEDING_EST_MASS_PROCESS_NOISE_G 2.0f    // g - unmodelled mass change per sample
+#define FEEDING_EST_RATE_PROCESS_NOISE 0.002f    // g/ms - dispense rate wander per sample
+
+// Flow-collapse detection: mass moved per motor-on ms over the last N cycles
+// (settled pulses, or FEEDING_NO_FLOW_WINDOW_MS of motor-on time while running continuously)
+#define FEEDING_NO_FLOW_CYCLES 3                 // Cycles averaged before judging (bounds detection time)
+#define FEEDING_NO_FLOW_RATE_FRACTION 0.2f       // Collapsed below this fraction of the learned/peak rate
+#define FEEDING_NO_FLOW_MIN_RATE 0.002f          // g/ms - collapsed below this regardless (2 g/s)
+#define FEEDING_NO_FLOW_WINDOW_MS 1500           // ms - motor-on time per cycle while running continuously
+#define FEEDING_NO_FLOW_MIN_EXPECTED_G 10.0f     // g - only judge when the cycles should have moved this much
+
+// Motor sense cross-check (MOTOR_SENSE_PIN vs commanded relay state)
+#define MOTOR_SENSE_STALL_DETECTION 1            // 1 = latch stall/run-on faults, 0 = sense pin not wired
+#define MOTOR_SENSE_STALL_TIME 300               // ms - relay-on time without sense activity (summed over pulses, or since it dropped out)
+#define MOTOR_SENSE_RUN_ON_TIME 400              // ms - sense still active after relay off (allows coast-down)
+
+// Status Reporting Deltas (a field is sent once its smoothed value moved this far
+// from the value last sent - the way back needs the full delta too)
 #define STATUS_FOOD_LEVEL_DELTA 0.05f            // kg - 50g change
 #define STATUS_HUMIDITY_DELTA 2.0f               // % - 2% change
 #define STATUS_TEMPERATURE_DELTA 1.0f            // °C - 1°C change
 #define STATUS_WATER_FLOW_DELTA 0.1f             // L - 0.1L change
-#define STATUS_HEARTBEAT_INTERVAL 300000         // ms - 5 min max without update
+#define STATUS_HEARTBEAT_INTERVAL 300000         // ms - full keyframe at least every 5 min
+
+// Status smoothing (EMA weight of a new reading, 1 = raw)
+#define STATUS_FOOD_LEVEL_EMA 0.3f               // Load cell noise around a delta boundary
+#define STATUS_HUMIDITY_EMA 0.2f
+#define STATUS_TEMPERATURE_EMA 0.2f
+#define STATUS_WATER_FLOW_EMA 1.0f               // Monotonic counter - no smoothing
+#define STATUS_EMA_SNAP_FACTOR 10.0f             // Jump > 10x delta (hopper refill) bypasses the EMA
+
+// Status rate limits per field: never more often than MIN, sub-delta drift still sent after MAX
+#define STATUS_FOOD_LEVEL_MIN_MS 2000            // ms
+#define STATUS_FOOD_LEVEL_MAX_MS 60000           // ms
+#define STATUS_CLIMATE_MIN_MS 30000              // ms - humidity / temperature
+#define STATUS_CLIMATE_MAX_MS 120000             // ms
+#define STATUS_WATER_FLOW_MIN_MS 5000            // ms
+#define STATUS_WATER_FLOW_MAX_MS 60000           // ms
+#define STATUS_LINK_MIN_MS 60000                 // ms - link error counters
 
 // Update Intervals
 #define LCD_DISPLAY_CYCLE_TIME 5000              // ms - cycle LCD display every 5s
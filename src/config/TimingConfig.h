@@ -8,7 +8,16 @@
 #define WDT_TIMEOUT_S              30       // Hardware watchdog (must survive I2C + sensor reads)
 
 // Main loop intervals
-#define SENSOR_READ_INTERVAL_MS    1000     // Sensor reads and status refresh
-#define SCHEDULE_CHECK_INTERVAL_MS 10000    // Scheduled feeding checks
+#define SCHEDULE_RETRY_INTERVAL_MS 10000    // Retry a matched schedule whose feed failed to start (same minute)
+#define SCHEDULE_INVALID_RTC_RETRY_MS 10000 // Re-read RTC while its time is invalid
 #define FAULT_CHECK_INTERVAL_MS    30000    // Fault detector sweep
 #define STATUS_REPORT_INTERVAL_MS  1000     // Serial2 status push to Master
+#define FEED_PROGRESS_INTERVAL_MS  150      // FEED_PROGRESS while feeding (~6.7 Hz)
+
+// Serial2 protocol
+#define SCHEDULE_STREAM_TIMEOUT_MS 2000     // Abandon a SCHEDULES: document with no bytes for this long
+#define SERIAL_RX_BUDGET_US        5000     // Max time per loop spent on received lines (rest waits a tick)
+#define LINK_BAUD_VERIFY_TIMEOUT_MS 1000    // LINK:TEST must arrive this soon after a baud change
+#define LINK_BAUD_ERROR_WINDOW_MS  10000    // Window for counting line errors at a negotiated baud
+#define LINK_BAUD_MAX_ERRORS       5        // Framing/CRC errors per window before falling back to SERIAL2_BAUD
+#define LINK_FLUSH_TIMEOUT_MS      500      // Max wait for Serial2 TX to drain (queued bytes are discarded after)
@@ -1,15 +1,21 @@
 #include "FaultManager.h"
+#include "../communication/SerialLink.h"
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 
 FaultManager::FaultManager()
-    : activeFaults_(FAULT_NONE),
+    : link_(nullptr),
+      activeFaults_(FAULT_NONE),
       faultLogCount_(0),
       faultLogIndex_(0) {
 }
 
+void FaultManager::setLink(SerialLink* link) {
+    link_ = link;
+}
+
 // ============================================================================
 // FAULT CONTROL
 // ============================================================================
@@ -74,13 +80,30 @@ void FaultManager::logFault(FaultCode code, const char* name, float value) {
 }
 
 void FaultManager::sendFaultToSerial(const FaultLog& fault) {
+    if (link_ && link_->isBinary()) {
+        // Fixed header followed by the name (no terminator)
+        uint8_t frame[sizeof(LinkFaultPayload) + sizeof(fault.name)];
+        LinkFaultPayload header;
+        header.timestamp = fault.timestamp;
+        header.code = fault.code;
+        header.valueX100 = (int32_t)lroundf(fault.value * 100.0f);
+        memcpy(frame, &header, sizeof(header));
+
+        size_t nameLen = strnlen(fault.name, sizeof(fault.name));
+        memcpy(frame + sizeof(header), fault.name, nameLen);
+        link_->sendFrame(MSG_FAULT, frame, sizeof(header) + nameLen, LINK_PRIO_URGENT);
+        return;
+    }
+
     // Build JSON fault message
     char message[256];
     snprintf(message, sizeof(message),
              "FAULT:{\"timestamp\":%lu,\"code\":%d,\"name\":\"%s\",\"value\":%.2f}",
              fault.timestamp, fault.code, fault.name, fault.value);
 
-    Serial2.println(message);
+    if (link_) {
+        link_->sendLine(message, LINK_PRIO_URGENT);
+    }
 }
 
 // ============================================================================
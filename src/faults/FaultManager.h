@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include "../config/DataStructures.h"
 
+class SerialLink;
+
 // ============================================================================
 // FAULT MANAGER
 // ============================================================================
@@ -12,6 +14,9 @@ class FaultManager {
 public:
     FaultManager();
 
+    // Route fault reports through the Serial2 link (MSG_FAULT frames in binary mode)
+    void setLink(SerialLink* link);
+
     // Set/clear faults
     void setFault(FaultCode fault, const char* name, float value = 0);
     void clearFault(FaultCode fault);
@@ -31,6 +36,7 @@ public:
     void sendFaultToSerial(const FaultLog& fault);
 
 private:
+    SerialLink* link_;
     uint8_t activeFaults_;
 
     // Circular fault log buffer
@@ -0,0 +1,82 @@
+#include "DispenseEstimator.h"
+#include "../config/FeedingConfig.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+DispenseEstimator::DispenseEstimator()
+    : mass_(0.0f),
+      rate_(0.0f),
+      p00_(0.0f),
+      p01_(0.0f),
+      p11_(0.0f) {
+}
+
+// ============================================================================
+// FILTER STEPS
+// ============================================================================
+
+void DispenseEstimator::reset(float initialRate) {
+    mass_ = 0.0f;
+    rate_ = initialRate > 0.0f ? initialRate : 0.0f;
+
+    // Mass known at start; rate only roughly known (+/-50% of prior)
+    p00_ = FEEDING_EST_NOISE_MOTOR_OFF_G * FEEDING_EST_NOISE_MOTOR_OFF_G;
+    p01_ = 0.0f;
+    float rateSigma = rate_ > 0.0f ? rate_ * 0.5f : FEEDING_EST_RATE_PROCESS_NOISE * 10.0f;
+    p11_ = rateSigma * rateSigma;
+}
+
+void DispenseEstimator::predict(float dtMs, bool motorOn) {
+    // x' = F x with F = [1 a; 0 1], a = dt while motor on (rate only acts with motor input)
+    float a = motorOn ? dtMs : 0.0f;
+    mass_ += a * rate_;
+
+    // P' = F P F^T + Q
+    p00_ += 2.0f * a * p01_ + a * a * p11_;
+    p01_ += a * p11_;
+    p00_ += FEEDING_EST_MASS_PROCESS_NOISE_G * FEEDING_EST_MASS_PROCESS_NOISE_G;
+    if (motorOn) {
+        p11_ += FEEDING_EST_RATE_PROCESS_NOISE * FEEDING_EST_RATE_PROCESS_NOISE;
+    }
+}
+
+void DispenseEstimator::update(float measuredG, bool motorOn) {
+    float noise = motorOn ? FEEDING_EST_NOISE_MOTOR_ON_G : FEEDING_EST_NOISE_MOTOR_OFF_G;
+
+    // H = [1 0]
+    float innovation = measuredG - mass_;
+    float s = p00_ + noise * noise;
+    float k0 = p00_ / s;
+    float k1 = p01_ / s;
+
+    mass_ += k0 * innovation;
+    rate_ += k1 * innovation;
+    if (rate_ < 0.0f) {
+        rate_ = 0.0f;  // Auger never pulls food back
+    }
+
+    // P = (I - K H) P
+    float p00 = p00_;
+    float p01 = p01_;
+    p00_ = (1.0f - k0) * p00;
+    p01_ = (1.0f - k0) * p01;
+    p11_ -= k1 * p01;
+}
+
+float DispenseEstimator::projectMass(float dtMs, bool motorOn) const {
+    return motorOn ? mass_ + rate_ * dtMs : mass_;
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+float DispenseEstimator::getMassG() const {
+    return mass_;
+}
+
+float DispenseEstimator::getRate() const {
+    return rate_;
+}
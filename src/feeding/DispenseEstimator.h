@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// DISPENSE ESTIMATOR
+// ============================================================================
+// Two-state Kalman filter for weigh-while-dispensing: state is dispensed mass
+// (g) and dispense rate (g/ms). The motor on/off signal is a known input -
+// mass only grows while the motor runs - so the noisy readings taken while
+// the auger vibrates the scale are weighted accordingly.
+
+class DispenseEstimator {
+public:
+    DispenseEstimator();
+
+    // Start a new run at 0 g with a prior rate (g/ms)
+    void reset(float initialRate);
+
+    // Advance the model by dtMs with the motor on/off
+    void predict(float dtMs, bool motorOn);
+
+    // Fuse a measured dispensed mass (g); noise depends on motor state
+    void update(float measuredG, bool motorOn);
+
+    // Estimated dispensed mass (g) dtMs after the last predict/update
+    float projectMass(float dtMs, bool motorOn) const;
+
+    float getMassG() const;
+    float getRate() const;    // g/ms
+
+private:
+    float mass_;
+    float rate_;
+
+    // Covariance P (symmetric 2x2)
+    float p00_;
+    float p01_;
+    float p11_;
+};
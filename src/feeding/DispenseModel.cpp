@@ -0,0 +1,124 @@
+#include "DispenseModel.h"
+#include "../config/FeedingConfig.h"
+
+// Upper pulse-length bound (ms) of each in-flight bucket; last bucket is open-ended
+// (runs longer than the longest predictive pulse come from continuous dispensing)
+static const uint16_t INFLIGHT_BUCKET_LIMITS[FEEDING_INFLIGHT_BUCKETS - 1] = {
+    75, 200, 600, FEEDING_MAX_PULSE_ON_TIME
+};
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+DispenseModel::DispenseModel() {
+}
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+void DispenseModel::setState(const DispenseModelState& state) {
+    if (state.version != DispenseModelState::CURRENT_VERSION ||
+        isnan(state.gramsPerMs) || state.gramsPerMs < 0.0f) {
+        Serial.println("[MODEL] Stored dispense model invalid - starting fresh");
+        state_ = DispenseModelState();
+        return;
+    }
+    state_ = state;
+    Serial.printf("[MODEL] Dispense rate loaded: %.4f g/ms (%u samples)\n",
+                  state_.gramsPerMs, state_.rateSamples);
+}
+
+const DispenseModelState& DispenseModel::getState() const {
+    return state_;
+}
+
+// ============================================================================
+// LEARNING
+// ============================================================================
+
+void DispenseModel::addRateSample(float grams, uint32_t onTimeMs) {
+    // Ignore cycles dominated by scale noise or with no motor time
+    if (onTimeMs == 0 || grams < FEEDING_RATE_MIN_SAMPLE_G) {
+        return;
+    }
+
+    float rate = grams / onTimeMs;
+
+    if (state_.rateSamples == 0 || state_.gramsPerMs <= 0.0f) {
+        state_.gramsPerMs = rate;
+    } else {
+        state_.gramsPerMs += FEEDING_RATE_LEARN_ALPHA * (rate - state_.gramsPerMs);
+    }
+
+    if (state_.rateSamples < UINT16_MAX) {
+        state_.rateSamples++;
+    }
+
+    Serial.printf("[MODEL] Rate sample: %.1f g in %lu ms = %.4f g/ms (model %.4f g/ms)\n",
+                  grams, (unsigned long)onTimeMs, rate, state_.gramsPerMs);
+}
+
+// ============================================================================
+// PREDICTION
+// ============================================================================
+
+bool DispenseModel::hasRate() const {
+    return state_.rateSamples > 0 && state_.gramsPerMs > 0.0f;
+}
+
+float DispenseModel::getGramsPerMs() const {
+    return state_.gramsPerMs;
+}
+
+uint16_t DispenseModel::pulseForGrams(float grams, uint16_t minMs, uint16_t maxMs) const {
+    if (!hasRate() || grams <= 0.0f) {
+        return minMs;
+    }
+    float ms = grams / state_.gramsPerMs;
+    if (ms < minMs) return minMs;
+    if (ms > maxMs) return maxMs;
+    return (uint16_t)ms;
+}
+
+// ============================================================================
+// IN-FLIGHT COMPENSATION
+// ============================================================================
+
+uint8_t DispenseModel::inflightBucket(uint16_t pulseMs) {
+    uint8_t bucket = 0;
+    while (bucket < FEEDING_INFLIGHT_BUCKETS - 1 && pulseMs > INFLIGHT_BUCKET_LIMITS[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void DispenseModel::addInflightSample(uint16_t pulseMs, float grams) {
+    // Negative = scale drift or tare noise; food never flows back into the hopper
+    if (isnan(grams) || grams < 0.0f) {
+        grams = 0.0f;
+    }
+
+    uint8_t bucket = inflightBucket(pulseMs);
+    if (state_.inflightSamples[bucket] == 0) {
+        state_.inflightG[bucket] = grams;
+    } else {
+        state_.inflightG[bucket] += FEEDING_INFLIGHT_LEARN_ALPHA * (grams - state_.inflightG[bucket]);
+    }
+
+    if (state_.inflightSamples[bucket] < UINT8_MAX) {
+        state_.inflightSamples[bucket]++;
+    }
+
+    Serial.printf("[MODEL] In-flight sample: %.1f g after %u ms pulse (bucket %u model %.1f g)\n",
+                  grams, pulseMs, bucket, state_.inflightG[bucket]);
+}
+
+float DispenseModel::predictInflightG(uint16_t pulseMs, float fallbackG) const {
+    uint8_t bucket = inflightBucket(pulseMs);
+    if (state_.inflightSamples[bucket] == 0) {
+        return fallbackG;
+    }
+    return state_.inflightG[bucket];
+}
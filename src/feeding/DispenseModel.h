@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/DataStructures.h"
+
+// ============================================================================
+// DISPENSE MODEL
+// ============================================================================
+// Online estimate of grams dispensed per ms of motor-on time, learned from
+// each pulse/settle cycle. Used to size the next pulse so a scheduled feed
+// converges in a handful of cycles. Also learns how much food still arrives
+// after the stop decision (in-flight mass) per pulse-length bucket, which sets
+// the stop point of the next feed. State is persisted by main via
+// PreferencesManager.
+
+class DispenseModel {
+public:
+    DispenseModel();
+
+    // Pulse length that selects the continuous-run in-flight bucket
+    static const uint16_t CONTINUOUS_RUN_MS = UINT16_MAX;
+
+    // Restore / export learned state (for NVS persistence)
+    void setState(const DispenseModelState& state);
+    const DispenseModelState& getState() const;
+
+    // Fold in one cycle: grams dispensed during onTimeMs of motor-on time
+    void addRateSample(float grams, uint32_t onTimeMs);
+
+    // True once at least one valid rate sample has been learned
+    bool hasRate() const;
+
+    // Learned rate (g/ms), 0 if not learned
+    float getGramsPerMs() const;
+
+    // Motor-on time (ms) expected to dispense `grams`, clamped to [minMs, maxMs]
+    uint16_t pulseForGrams(float grams, uint16_t minMs, uint16_t maxMs) const;
+
+    // Fold in one feed: grams that arrived after stopping on a pulse of pulseMs
+    void addInflightSample(uint16_t pulseMs, float grams);
+
+    // Expected in-flight grams after a pulse of pulseMs (fallbackG if bucket not learned yet)
+    float predictInflightG(uint16_t pulseMs, float fallbackG) const;
+
+private:
+    DispenseModelState state_;
+
+    static uint8_t inflightBucket(uint16_t pulseMs);
+};
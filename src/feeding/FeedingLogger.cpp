@@ -1,37 +1,103 @@
 #include "FeedingLogger.h"
+#include "../communication/SerialLink.h"
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 
-FeedingLogger::FeedingLogger() {
+FeedingLogger::FeedingLogger()
+    : link_(nullptr) {
+}
+
+void FeedingLogger::setLink(SerialLink* link) {
+    link_ = link;
 }
 
 // ============================================================================
 // LOGGING
 // ============================================================================
 
-void FeedingLogger::logFeeding(FeedingTrigger trigger, float amount, FeedingResult result, const char* timestamp) {
+void FeedingLogger::logFeeding(const FeedingReport& report, const char* timestamp) {
     // Only log successful or low-level feedings
-    if (result == RESULT_SUCCESS || result == RESULT_LOW_LEVEL) {
-        sendLog(timestamp, amount, trigger);
+    if (report.result == RESULT_SUCCESS || report.result == RESULT_LOW_LEVEL) {
+        sendLog(timestamp, report);
     }
 }
 
-void FeedingLogger::sendLog(const char* timestamp, float amount, FeedingTrigger trigger) {
+void FeedingLogger::sendLog(const char* timestamp, const FeedingReport& report) {
+    if (link_ && link_->isBinary()) {
+        LinkLogPayload payload;
+        memset(payload.timestamp, 0, sizeof(payload.timestamp));
+        strncpy(payload.timestamp, timestamp, sizeof(payload.timestamp));
+        payload.weightG = (int32_t)lroundf(report.amount * 1000.0f);
+        payload.trigger = (uint8_t)report.trigger;
+        payload.cycles = report.pulseCycles;
+        payload.durationMs = report.durationMs;
+        payload.senseDutyPct = report.senseDutyPct;
+        payload.senseEdges = report.senseEdges;
+
+        link_->sendFrame(MSG_LOG, &payload, sizeof(payload));
+        Serial.printf("[LOG] Feeding logged (frame): %s %ldg\n", timestamp, (long)payload.weightG);
+        return;
+    }
+
     // Build JSON log message (weight as number to match WiFi ESP format)
+    // cycles/durationMs let the app compare feed speed across dispense schemes
+    // senseDuty/senseEdges show motor health (low duty = auger labouring or sense wiring)
     char logMessage[256];
     snprintf(logMessage, sizeof(logMessage),
-             "LOG:{\"timestamp\":\"%s\",\"weight\":%.2f,\"type\":\"%s\"}",
-             timestamp, amount, getTriggerString(trigger));
+             "LOG:{\"timestamp\":\"%s\",\"weight\":%.2f,\"type\":\"%s\",\"cycles\":%u,\"durationMs\":%lu,"
+             "\"senseDuty\":%u,\"senseEdges\":%u}",
+             timestamp, report.amount, getTriggerString(report.trigger),
+             report.pulseCycles, report.durationMs, report.senseDutyPct, report.senseEdges);
 
-    // Send via Serial2 to WiFi ESP
-    Serial2.println(logMessage);
+    // Queue for the WiFi ESP
+    if (link_) {
+        link_->sendLine(logMessage);
+    }
 
     // Also print to Serial for debugging
     Serial.printf("[LOG] Feeding logged: %s\n", logMessage);
 }
 
+// ============================================================================
+// LIVE PROGRESS
+// ============================================================================
+
+void FeedingLogger::sendProgress(const FeedingProgress& progress) {
+    int32_t dispensedG = (int32_t)lroundf(progress.dispensed * 1000.0f);
+    int32_t targetG = (int32_t)lroundf(progress.target * 1000.0f);
+
+    if (link_ && link_->isBinary()) {
+        LinkFeedProgressPayload payload;
+        payload.state = (uint8_t)progress.state;
+        payload.trigger = (uint8_t)progress.trigger;
+        payload.result = (uint8_t)progress.result;
+        payload.dispensedG = dispensedG;
+        payload.targetG = targetG;
+        payload.cycles = progress.pulseCycles;
+        payload.elapsedMs = progress.elapsedMs;
+
+        // Next snapshot supersedes this one - never let them pile up
+        if (link_->canQueue(LINK_PRIO_NORMAL, BinaryFrame::MAX_ENCODED)) {
+            link_->sendFrame(MSG_FEED_PROGRESS, &payload, sizeof(payload));
+        }
+        return;
+    }
+
+    // FEED_PROGRESS:<state>,<trigger>,<result>,<dispensedG>,<targetG>,<cycles>,<elapsedMs>
+    char line[80];
+    snprintf(line, sizeof(line), "FEED_PROGRESS:%u,%u,%u,%ld,%ld,%u,%lu",
+             progress.state, progress.trigger, progress.result,
+             (long)dispensedG, (long)targetG, progress.pulseCycles, progress.elapsedMs);
+
+    if (link_) {
+        if (link_->canQueue(LINK_PRIO_NORMAL, sizeof(line))) {
+            link_->sendLine(line);
+        }
+    }
+}
+
 // ============================================================================
 // HELPERS
 // ============================================================================
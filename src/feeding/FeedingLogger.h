@@ -3,22 +3,33 @@
 #include <Arduino.h>
 #include "../config/DataStructures.h"
 
+class SerialLink;
+
 // ============================================================================
 // FEEDING LOGGER
 // ============================================================================
 // Logs feeding events and sends to WiFi ESP
+// Also streams live FEED_PROGRESS snapshots while a feed runs
 
 class FeedingLogger {
 public:
     FeedingLogger();
 
+    // Route logs through the Serial2 link (compact MSG_LOG frames in binary mode)
+    void setLink(SerialLink* link);
+
     // Log a feeding event
-    void logFeeding(FeedingTrigger trigger, float amount, FeedingResult result, const char* timestamp);
+    void logFeeding(const FeedingReport& report, const char* timestamp);
 
     // Send log via Serial2
-    void sendLog(const char* timestamp, float amount, FeedingTrigger trigger);
+    void sendLog(const char* timestamp, const FeedingReport& report);
+
+    // Send one live progress snapshot (dropped rather than queued behind a full link)
+    void sendProgress(const FeedingProgress& progress);
 
 private:
+    SerialLink* link_;
+
     // Format trigger as string
     const char* getTriggerString(FeedingTrigger trigger);
 };
@@ -21,6 +21,26 @@ FeedingStateMachine::FeedingStateMachine()
       feedingStartTime_(0),
       cooldownStartTime_(0),
       settleStartTime_(0),
+      settleStartSample_(0),
+      feedingEndTime_(0),
+      pulseCycles_(0),
+      lastPulseOnTime_(0),
+      lastSettledDispensed_(0),
+      progressDispensed_(0),
+      motorRunStartTime_(0),
+      estimatorTime_(0),
+      estimatorSample_(0),
+      estimateAtStop_(0),
+      lastRunContinuous_(false),
+      topUpOnly_(false),
+      stopDispensed_(-1.0f),
+      stopPulseOnTime_(0),
+      flowCycleHead_(0),
+      flowCycleCount_(0),
+      flowPeakRate_(0),
+      flowWindowOnMs_(0),
+      flowWindowWeight_(0),
+      finishCallback_(nullptr),
       cooldownCallback_(nullptr) {
 }
 
@@ -33,6 +53,10 @@ void FeedingStateMachine::begin(MotorController* motor, WeightSensor* weightSens
     weightSensor_ = weightSensor;
 }
 
+void FeedingStateMachine::setFinishCallback(FeedingFinishedCallback callback) {
+    finishCallback_ = callback;
+}
+
 void FeedingStateMachine::setCooldownCallback(CooldownCompleteCallback callback) {
     cooldownCallback_ = callback;
 }
@@ -59,8 +83,9 @@ bool FeedingStateMachine::startFeeding(FeedingTrigger trigger, float targetAmoun
         Serial.printf("[FSM] Manual feeding: target=%.3f kg\n", targetAmount_);
     } else if (trigger == TRIGGER_SCHEDULE) {
         targetAmount_ = targetAmount;  // From schedule
-        Serial.printf("[FSM] Scheduled feeding: target=%.3f kg, effective=%.3f kg (stop-early)\n",
-                      targetAmount_, targetAmount_ * FEEDING_STOP_EARLY_FACTOR);
+        lastPulseOnTime_ = 0;
+        Serial.printf("[FSM] Scheduled feeding: target=%.3f kg, initial stop point=%.3f kg (in-flight comp)\n",
+                      targetAmount_, getStopPoint());
     } else {
         Serial.println("[FSM] ERROR: Invalid trigger");
         return false;  // Invalid trigger
@@ -92,10 +117,25 @@ bool FeedingStateMachine::startFeeding(FeedingTrigger trigger, float targetAmoun
         return false;
     }
 
+    // Fresh sense cross-check and duty statistics for this feed
+    if (motor_) {
+        motor_->clearSenseFault();
+        motor_->resetSenseStats();
+    }
+
     // Start feeding
     state_ = FEEDING_STARTING;
     feedingStartTime_ = millis();
+    feedingEndTime_ = 0;
     lastResult_ = RESULT_NONE;
+    pulseCycles_ = 0;
+    lastSettledDispensed_ = 0;
+    progressDispensed_ = 0;
+    lastPulseOnTime_ = 0;
+    lastRunContinuous_ = false;
+    topUpOnly_ = false;
+    stopDispensed_ = -1.0f;
+    resetFlowCheck();
 
     Serial.println("[FSM] Feeding started successfully");
     return true;
@@ -120,6 +160,13 @@ void FeedingStateMachine::stopFeeding(FeedingResult result) {
 // ============================================================================
 
 void FeedingStateMachine::update() {
+    // Motor sense fault latched by MotorController - abort instead of waiting for the timeout
+    if (isMotorActiveState() && motor_ && motor_->getSenseFault() != MOTOR_SENSE_OK) {
+        Serial.printf("[FSM] ERROR: Motor sense fault (%s) - aborting\n",
+                      motor_->getSenseFault() == MOTOR_SENSE_STALL ? "stall" : "run-on");
+        stopFeeding(RESULT_MOTOR_STALL);
+    }
+
     switch (state_) {
         case FEEDING_IDLE:
             handleIdle();
@@ -141,6 +188,10 @@ void FeedingStateMachine::update() {
             handleSettling();
             break;
 
+        case FEEDING_CONTINUOUS:
+            handleContinuous();
+            break;
+
         case FEEDING_FINISHING:
             handleFinishing();
             break;
@@ -172,12 +223,20 @@ void FeedingStateMachine::handleStarting() {
         }
         state_ = FEEDING_DISPENSING;
     } else {
+#if FEEDING_CONTINUOUS_MODE
+        // Large scheduled feed with a known dispense rate: weigh while dispensing
+        if (targetAmount_ >= FEEDING_CONTINUOUS_MIN_AMOUNT && dispenseModel_.hasRate()) {
+            startContinuous();
+            return;
+        }
+#endif
         // Scheduled feed: go directly to pulse-and-weigh cycle
         // Start first pulse with adaptive timing
-        uint16_t onTime = getCurrentPulseOnTime();
+        uint16_t onTime = getCurrentPulseOnTime(0.0f);
         if (motor_) {
-            motor_->startPulsing(onTime, FEEDING_PULSE_OFF_TIME);
+            motor_->pulseOnce(onTime);
         }
+        lastPulseOnTime_ = onTime;
         Serial.printf("[FSM] Schedule feed: starting pulse-and-weigh (pulse=%dms)\n", onTime);
         state_ = FEEDING_PULSING;
     }
@@ -197,6 +256,11 @@ void FeedingStateMachine::handleDispensing() {
         return;
     }
 
+    if (checkFlowWindow()) {
+        stopFeeding(RESULT_NO_FLOW);
+        return;
+    }
+
     // Check if should start pulsing
     if (shouldStartPulsing()) {
         if (motor_) {
@@ -219,13 +283,18 @@ void FeedingStateMachine::handlePulsing() {
             stopFeeding(RESULT_SUCCESS);
             return;
         }
+        if (checkFlowWindow()) {
+            stopFeeding(RESULT_NO_FLOW);
+            return;
+        }
     } else {
-        // Scheduled feed: after one pulse ON+OFF cycle, stop and settle
-        // Wait for the motor to complete its OFF phase (pulse cycle done)
-        if (motor_ && !motor_->isRunning() && motor_->isPulsing()) {
-            // Motor is in OFF phase of pulse - stop it and go to settle
+        // Scheduled feed: one single-shot pulse, then settle
+        // The motor turns itself off at the end of the ON period and never re-arms,
+        // so a slow loop here cannot add an unrequested pulse
+        if (motor_ && motor_->isPulseComplete()) {
             motor_->stop();
             settleStartTime_ = millis();
+            settleStartSample_ = weightSensor_ ? weightSensor_->getSampleCount() : 0;
             state_ = FEEDING_SETTLING;
         }
     }
@@ -240,14 +309,48 @@ void FeedingStateMachine::handleSettling() {
         return;
     }
 
+    // Advance as soon as post-stop samples are stable, capped at FEEDING_SETTLE_MAX_TIME
     unsigned long elapsed = millis() - settleStartTime_;
-    if (elapsed < FEEDING_SETTLE_TIME) {
+    bool stable = weightSensor_ && weightSensor_->isStable(settleStartSample_);
+    if (!stable && elapsed < FEEDING_SETTLE_MAX_TIME) {
         return;  // Still waiting for scale to settle
     }
 
-    // Settle time elapsed - read weight (fast read for quicker feedback)
-    float dispensed = weightBefore_ - getCurrentWeightFast();
-    float effectiveTarget = targetAmount_ * FEEDING_STOP_EARLY_FACTOR;
+    Serial.printf("[FSM] Settled in %lu ms (%s)\n", elapsed, stable ? "stable" : "max wait");
+
+    // Scale settled - read weight (fast read = mean of the stable window)
+    float currentWeight = getCurrentWeightFast();
+    if (currentWeight <= SENSOR_ERROR_VALUE) {
+        Serial.println("[FSM] ERROR: Weight sensor error during settle read - aborting");
+        stopFeeding(RESULT_ERROR);
+        return;
+    }
+    float dispensed = weightBefore_ - currentWeight;
+
+    // Learn grams-per-ms from the pulse that just settled
+    pulseCycles_++;
+    float cycleG = (dispensed - lastSettledDispensed_) * 1000.0f;
+    uint32_t cycleOnMs = getActualOnTime();
+    dispenseModel_.addRateSample(cycleG, cycleOnMs);
+    lastSettledDispensed_ = dispensed;
+
+    // After a continuous run: learn its in-flight mass, then any top-up uses short pulses
+    bool afterContinuous = lastRunContinuous_;
+
+    // Continuous runs already fed the flow check window by window
+    if (!afterContinuous) {
+        recordFlowCycle(cycleG, cycleOnMs);
+    }
+    if (afterContinuous) {
+        dispenseModel_.addInflightSample(DispenseModel::CONTINUOUS_RUN_MS,
+                                         dispensed * 1000.0f - estimateAtStop_);
+        lastPulseOnTime_ = FEEDING_MIN_PULSE_ON_TIME;
+        lastRunContinuous_ = false;
+        topUpOnly_ = true;
+    }
+
+    // Stop point depends on the in-flight mass learned for this pulse length
+    float effectiveTarget = getStopPoint();
 
     Serial.printf("[FSM] Settle read: dispensed=%.3f kg, effective_target=%.3f kg (actual=%.3f kg)\n",
                   dispensed, effectiveTarget, targetAmount_);
@@ -256,20 +359,100 @@ void FeedingStateMachine::handleSettling() {
         // Target reached (with stop-early offset)
         Serial.printf("[FSM] Target reached! Dispensed %.3f kg (target %.3f kg, effective %.3f kg)\n",
                       dispensed, targetAmount_, effectiveTarget);
+        if (!afterContinuous) {
+            stopDispensed_ = dispensed;  // Continuous in-flight was already learned above
+            stopPulseOnTime_ = lastPulseOnTime_;
+        }
         stopFeeding(RESULT_SUCCESS);
         return;
     }
 
+    // Pulses keep running but food stopped arriving - don't burn the rest of the timeout
+    if (isFlowCollapsed()) {
+        stopFeeding(RESULT_NO_FLOW);
+        return;
+    }
+
     // Not enough dispensed yet - start another pulse cycle
-    uint16_t onTime = getCurrentPulseOnTime();
+    // (after a continuous run only the small shortfall is left: minimum pulses)
+    uint16_t onTime = topUpOnly_ ? FEEDING_MIN_PULSE_ON_TIME : getCurrentPulseOnTime(dispensed);
     if (motor_) {
-        motor_->startPulsing(onTime, FEEDING_PULSE_OFF_TIME);
+        motor_->pulseOnce(onTime);
     }
+    lastPulseOnTime_ = onTime;
     Serial.printf("[FSM] Another pulse cycle (pulse=%dms, remaining=%.3f kg)\n",
                   onTime, effectiveTarget - dispensed);
     state_ = FEEDING_PULSING;
 }
 
+void FeedingStateMachine::startContinuous() {
+    estimator_.reset(dispenseModel_.getGramsPerMs());
+    estimatorTime_ = millis();
+    estimatorSample_ = weightSensor_ ? weightSensor_->getSampleCount() : 0;
+    motorRunStartTime_ = millis();
+    lastRunContinuous_ = true;
+
+    if (motor_) {
+        motor_->start();
+    }
+    Serial.printf("[FSM] Schedule feed: continuous weigh-while-dispensing (rate=%.4f g/ms)\n",
+                  dispenseModel_.getGramsPerMs());
+    state_ = FEEDING_CONTINUOUS;
+}
+
+void FeedingStateMachine::handleContinuous() {
+    // Motor running, estimator fuses every new sample with the motor state as known input
+    if (isTimeoutReached()) {
+        stopFeeding(RESULT_TIMEOUT);
+        return;
+    }
+
+    unsigned long now = millis();
+    bool motorOn = motor_ && motor_->isRunning();
+
+    if (weightSensor_ && weightSensor_->getSampleCount() != estimatorSample_) {
+        estimatorSample_ = weightSensor_->getSampleCount();
+        float weight = weightSensor_->getLatestWeight();
+        if (weight <= SENSOR_ERROR_VALUE) {
+            Serial.println("[FSM] ERROR: Weight sensor error while dispensing - aborting");
+            stopFeeding(RESULT_ERROR);
+            return;
+        }
+        estimator_.predict(now - estimatorTime_, motorOn);
+        estimator_.update((weightBefore_ - weight) * 1000.0f, motorOn);
+        estimatorTime_ = now;
+    }
+
+    if (checkFlowWindow()) {
+        stopFeeding(RESULT_NO_FLOW);
+        return;
+    }
+
+    // Project to this instant so the stop is not quantized to the 10 SPS sample rate
+    float projectedG = estimator_.projectMass(now - estimatorTime_, motorOn);
+    float fallbackG = targetAmount_ * (1.0f - FEEDING_STOP_EARLY_FACTOR) * 1000.0f;
+    float inflightG = dispenseModel_.predictInflightG(DispenseModel::CONTINUOUS_RUN_MS, fallbackG);
+
+    if (projectedG + inflightG < targetAmount_ * 1000.0f) {
+        return;
+    }
+
+    if (motor_) {
+        motor_->stop();
+    }
+    unsigned long runMs = motor_ && motor_->getLastOnDurationUs() ? getActualOnTime()
+                                                                  : now - motorRunStartTime_;
+    lastPulseOnTime_ = min<unsigned long>(runMs, UINT16_MAX - 1);
+    estimateAtStop_ = projectedG;
+    Serial.printf("[FSM] Continuous stop: est=%.1f g + in-flight=%.1f g (rate=%.4f g/ms, run=%lu ms)\n",
+                  projectedG, inflightG, estimator_.getRate(), runMs);
+
+    // Settle and verify; short pulses top up if the estimate was optimistic
+    settleStartTime_ = now;
+    settleStartSample_ = weightSensor_ ? weightSensor_->getSampleCount() : 0;
+    state_ = FEEDING_SETTLING;
+}
+
 void FeedingStateMachine::handleFinishing() {
     // Ensure motor is stopped
     if (motor_) {
@@ -279,17 +462,30 @@ void FeedingStateMachine::handleFinishing() {
     // Capture final weight after motor stops (before it can stabilize further)
     // This gives us the best estimate of actual amount dispensed
     weightAfter_ = getCurrentWeight();
+    feedingEndTime_ = millis();
     Serial.printf("[FSM] Final weight captured: %.3f kg (dispensed: %.3f kg)\n",
                   weightAfter_, weightBefore_ - weightAfter_);
+    Serial.printf("[FSM] Feed summary: cycles=%u, duration=%lu ms, rate=%.4f g/ms\n",
+                  pulseCycles_, getFeedDuration(), dispenseModel_.getGramsPerMs());
 
     // Move to cooldown
     state_ = FEEDING_COOLDOWN_STATE;
     cooldownStartTime_ = millis();
+
+    // Report the outcome now rather than after FEEDING_COOLDOWN
+    if (finishCallback_) {
+        finishCallback_();
+    }
 }
 
 void FeedingStateMachine::handleCooldown() {
     unsigned long elapsed = millis() - cooldownStartTime_;
 
+    // Once everything has landed, learn how far past the stop point the feed went
+    if (stopDispensed_ >= 0 && elapsed >= FEEDING_INFLIGHT_MEASURE_DELAY) {
+        measureInflight();
+    }
+
     if (elapsed >= FEEDING_COOLDOWN) {
         // Notify callback BEFORE resetting state (so it can read trigger/result)
         if (cooldownCallback_) {
@@ -343,8 +539,8 @@ bool FeedingStateMachine::isTargetReached() {
         return dispensed >= FEEDING_MIN_DISPENSE;
     }
 
-    // For schedule: effective target (with stop-early factor)
-    return dispensed >= (targetAmount_ * FEEDING_STOP_EARLY_FACTOR);
+    // For schedule: effective target (with in-flight compensation)
+    return dispensed >= getStopPoint();
 }
 
 bool FeedingStateMachine::shouldStartPulsing() {
@@ -354,9 +550,17 @@ bool FeedingStateMachine::shouldStartPulsing() {
     return dispensed >= pulseThreshold_;
 }
 
-uint16_t FeedingStateMachine::getCurrentPulseOnTime() const {
+uint16_t FeedingStateMachine::getCurrentPulseOnTime(float dispensed) const {
+#if FEEDING_PREDICTIVE_PULSES
+    // Predictive: size the pulse to cover a fraction of what is still missing
+    if (dispenseModel_.hasRate()) {
+        float remainingG = (getStopPoint() - dispensed) * 1000.0f;
+        return dispenseModel_.pulseForGrams(remainingG * FEEDING_PULSE_REMAINING_FRACTION,
+                                            FEEDING_MIN_PULSE_ON_TIME, FEEDING_MAX_PULSE_ON_TIME);
+    }
+#endif
+
     // Adaptive pulse: longer when far from target, shorter when close
-    float dispensed = weightBefore_ - (weightSensor_ ? weightSensor_->readWeightFast() : 0);
     float remaining = targetAmount_ - dispensed;
     float remainingRatio = remaining / targetAmount_;
 
@@ -366,15 +570,123 @@ uint16_t FeedingStateMachine::getCurrentPulseOnTime() const {
     return FEEDING_SHORT_PULSE_ON_TIME;  // Close to target: 50ms pulses
 }
 
+uint32_t FeedingStateMachine::getActualOnTime() const {
+    // Measured from the motor's relay edge timestamps; commanded time as fallback
+    uint32_t onUs = motor_ ? motor_->getLastOnDurationUs() : 0;
+    if (onUs == 0) {
+        return lastPulseOnTime_;
+    }
+    return (onUs + 500) / 1000;
+}
+
+void FeedingStateMachine::resetFlowCheck() {
+    flowCycleHead_ = 0;
+    flowCycleCount_ = 0;
+    flowPeakRate_ = 0;
+    flowWindowOnMs_ = 0;
+    flowWindowWeight_ = weightBefore_;
+}
+
+void FeedingStateMachine::recordFlowCycle(float grams, uint32_t onMs) {
+    if (onMs == 0) return;
+
+    flowCycleG_[flowCycleHead_] = grams;
+    flowCycleMs_[flowCycleHead_] = onMs;
+    flowCycleHead_ = (flowCycleHead_ + 1) % FEEDING_NO_FLOW_CYCLES;
+    if (flowCycleCount_ < FEEDING_NO_FLOW_CYCLES) {
+        flowCycleCount_++;
+    }
+
+    float rate = grams / onMs;
+    if (rate > flowPeakRate_) {
+        flowPeakRate_ = rate;
+    }
+}
+
+bool FeedingStateMachine::checkFlowWindow() {
+    // Motor-on time comes from the relay edge accounting, so pulse OFF phases don't count
+    if (!motor_) return false;
+    uint32_t onMs = motor_->getSenseStats().commandedOnMs;
+    if (onMs - flowWindowOnMs_ < FEEDING_NO_FLOW_WINDOW_MS) {
+        return false;
+    }
+
+    float weight = getCurrentWeightFast();
+    if (weight <= SENSOR_ERROR_VALUE) {
+        return false;  // Sensor errors are handled by the state handlers
+    }
+    recordFlowCycle((flowWindowWeight_ - weight) * 1000.0f, onMs - flowWindowOnMs_);
+    flowWindowOnMs_ = onMs;
+    flowWindowWeight_ = weight;
+    return isFlowCollapsed();
+}
+
+bool FeedingStateMachine::isFlowCollapsed() const {
+    if (flowCycleCount_ < FEEDING_NO_FLOW_CYCLES) {
+        return false;  // Not enough history to judge
+    }
+
+    float grams = 0;
+    uint32_t onMs = 0;
+    for (uint8_t i = 0; i < FEEDING_NO_FLOW_CYCLES; i++) {
+        grams += flowCycleG_[i];
+        onMs += flowCycleMs_[i];
+    }
+    float rate = onMs > 0 ? grams / onMs : 0;
+
+    // Reference: learned model rate, else the best this feed has managed
+    float reference = dispenseModel_.hasRate() ? dispenseModel_.getGramsPerMs() : flowPeakRate_;
+    float limit = max(reference * FEEDING_NO_FLOW_RATE_FRACTION, FEEDING_NO_FLOW_MIN_RATE);
+
+    // Tiny top-up pulses near the target move less than the scale noise - don't judge those
+    if (max(reference, FEEDING_NO_FLOW_MIN_RATE) * onMs < FEEDING_NO_FLOW_MIN_EXPECTED_G) {
+        return false;
+    }
+    if (rate >= limit) {
+        return false;
+    }
+
+    Serial.printf("[FSM] ERROR: Flow collapsed - %.4f g/ms over last %d cycles (limit %.4f, reference %.4f)\n",
+                  rate, FEEDING_NO_FLOW_CYCLES, limit, reference);
+    return true;
+}
+
+float FeedingStateMachine::getStopPoint() const {
+    // Fallback until this pulse length has been learned: the fixed stop-early factor
+    float fallbackG = targetAmount_ * (1.0f - FEEDING_STOP_EARLY_FACTOR) * 1000.0f;
+    float inflightKg = dispenseModel_.predictInflightG(lastPulseOnTime_, fallbackG) / 1000.0f;
+    inflightKg = constrain(inflightKg, 0.0f, targetAmount_ * FEEDING_INFLIGHT_MAX_FRACTION);
+    return targetAmount_ - inflightKg;
+}
+
+void FeedingStateMachine::measureInflight() {
+    float settledWeight = getCurrentWeight();
+    if (settledWeight > SENSOR_ERROR_VALUE) {
+        float finalDispensed = weightBefore_ - settledWeight;
+        Serial.printf("[FSM] In-flight: stopped at %.3f kg, settled at %.3f kg\n",
+                      stopDispensed_, finalDispensed);
+        dispenseModel_.addInflightSample(stopPulseOnTime_, (finalDispensed - stopDispensed_) * 1000.0f);
+    }
+    stopDispensed_ = -1.0f;  // One observation per feed
+}
+
 // ============================================================================
 // STATUS METHODS
 // ============================================================================
 
+bool FeedingStateMachine::isMotorActiveState() const {
+    return (state_ == FEEDING_DISPENSING ||
+            state_ == FEEDING_PULSING ||
+            state_ == FEEDING_SETTLING ||
+            state_ == FEEDING_CONTINUOUS);
+}
+
 bool FeedingStateMachine::isFeeding() const {
     return (state_ == FEEDING_STARTING ||
             state_ == FEEDING_DISPENSING ||
             state_ == FEEDING_PULSING ||
-            state_ == FEEDING_SETTLING);
+            state_ == FEEDING_SETTLING ||
+            state_ == FEEDING_CONTINUOUS);
 }
 
 FeedingState FeedingStateMachine::getState() const {
@@ -400,3 +712,53 @@ float FeedingStateMachine::getDispensedAmount() const {
 float FeedingStateMachine::getWeightBefore() const {
     return weightBefore_;
 }
+
+uint16_t FeedingStateMachine::getPulseCycles() const {
+    return pulseCycles_;
+}
+
+FeedingProgress FeedingStateMachine::getProgress() const {
+    FeedingProgress progress;
+    progress.state = state_;
+    progress.trigger = trigger_;
+    progress.result = lastResult_;
+    progress.target = targetAmount_;
+    progress.pulseCycles = pulseCycles_;
+    progress.elapsedMs = getFeedDuration();
+
+    // A stale or failed scale keeps the last good value rather than reporting
+    // weightBefore_ - SENSOR_ERROR_VALUE (staleness is checked first: reading a
+    // stale scale would log on every call at this rate)
+    if (state_ == FEEDING_IDLE || state_ == FEEDING_COOLDOWN_STATE) {
+        if (weightAfter_ != SENSOR_ERROR_VALUE) {
+            progressDispensed_ = weightBefore_ - weightAfter_;
+        }
+    } else if (weightSensor_ && !weightSensor_->isStale()) {
+        float weight = weightSensor_->readWeightFast();
+        if (weight != SENSOR_ERROR_VALUE) {
+            progressDispensed_ = weightBefore_ - weight;
+        }
+    }
+    progress.dispensed = progressDispensed_;
+    return progress;
+}
+
+unsigned long FeedingStateMachine::getFeedDuration() const {
+    if (feedingStartTime_ == 0) {
+        return 0;
+    }
+    unsigned long end = feedingEndTime_ ? feedingEndTime_ : millis();
+    return end - feedingStartTime_;
+}
+
+// ============================================================================
+// DISPENSE MODEL
+// ============================================================================
+
+void FeedingStateMachine::setDispenseModelState(const DispenseModelState& state) {
+    dispenseModel_.setState(state);
+}
+
+const DispenseModelState& FeedingStateMachine::getDispenseModelState() const {
+    return dispenseModel_.getState();
+}
@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 #include "../config/DataStructures.h"
+#include "DispenseModel.h"
+#include "DispenseEstimator.h"
 
 // Forward declarations
 class MotorController;
@@ -12,6 +14,7 @@ class WeightSensor;
 // ============================================================================
 // Non-blocking state machine for feeding control
 // States: IDLE → STARTING → DISPENSING → PULSING → FINISHING → COOLDOWN
+// Scheduled: STARTING → [CONTINUOUS →] (SETTLING ↔ PULSING) → FINISHING → COOLDOWN
 // Handles both manual and scheduled feeding with different targets
 
 class FeedingStateMachine {
@@ -37,6 +40,18 @@ public:
     FeedingResult getLastResult() const;
     float getDispensedAmount() const;
     float getWeightBefore() const;  // Get weight reading before feeding attempt
+    uint16_t getPulseCycles() const;        // Pulse/settle cycles in current/last feed
+    unsigned long getFeedDuration() const;  // ms from start to motor stop (live while feeding)
+    FeedingProgress getProgress() const;    // Non-blocking snapshot for live telemetry
+
+    // Learned dispense rate (persisted by caller)
+    void setDispenseModelState(const DispenseModelState& state);
+    const DispenseModelState& getDispenseModelState() const;
+
+    // Set finish callback (called as soon as the final weight is captured;
+    // trigger/result/amount are final, cooldown is just starting)
+    typedef void (*FeedingFinishedCallback)();
+    void setFinishCallback(FeedingFinishedCallback callback);
 
     // Set cooldown callback (called when cooldown completes)
     typedef void (*CooldownCompleteCallback)();
@@ -60,8 +75,40 @@ private:
     unsigned long feedingStartTime_;
     unsigned long cooldownStartTime_;
     unsigned long settleStartTime_;  // When motor stopped for settle phase
+    uint32_t settleStartSample_;     // Weight sample count when motor stopped (settle detection marker)
+    unsigned long feedingEndTime_;   // When motor stopped for good (0 while feeding)
+
+    // Pulse-and-weigh bookkeeping (scheduled feed)
+    DispenseModel dispenseModel_;
+    uint16_t pulseCycles_;           // Completed pulse/settle cycles
+    uint16_t lastPulseOnTime_;       // ms - motor-on time of the pulse being settled
+    float lastSettledDispensed_;     // kg - dispensed at previous settle read
+    mutable float progressDispensed_; // kg - last good live reading for getProgress()
+
+    // Continuous weigh-while-dispensing (large scheduled feeds)
+    DispenseEstimator estimator_;
+    unsigned long motorRunStartTime_;  // When the continuous run started
+    unsigned long estimatorTime_;      // millis() of last estimator predict/update
+    uint32_t estimatorSample_;         // Last weight sample fed to the estimator
+    float estimateAtStop_;             // g - estimated dispensed when the motor was stopped
+    bool lastRunContinuous_;           // Settle in progress follows a continuous run
+    bool topUpOnly_;                   // Continuous run done - remaining pulses are FEEDING_MIN_PULSE_ON_TIME
+
+    // In-flight learning (scheduled feed): dispensed at the stop decision vs fully settled later
+    float stopDispensed_;            // kg - dispensed when the stop decision was made (<0 = none)
+    uint16_t stopPulseOnTime_;       // ms - length of the pulse before stopping
+
+    // Flow-collapse detection: grams and motor-on ms of the last N cycles
+    float flowCycleG_[FEEDING_NO_FLOW_CYCLES];
+    uint32_t flowCycleMs_[FEEDING_NO_FLOW_CYCLES];
+    uint8_t flowCycleHead_;
+    uint8_t flowCycleCount_;
+    float flowPeakRate_;             // g/ms - best cycle rate seen this feed
+    uint32_t flowWindowOnMs_;        // Motor-on ms at start of the current continuous-run window
+    float flowWindowWeight_;         // kg - weight at start of the current continuous-run window
 
     // Callbacks
+    FeedingFinishedCallback finishCallback_;
     CooldownCompleteCallback cooldownCallback_;
 
     // State handlers
@@ -70,6 +117,7 @@ private:
     void handleDispensing();
     void handlePulsing();
     void handleSettling();
+    void handleContinuous();
     void handleFinishing();
     void handleCooldown();
 
@@ -81,5 +129,14 @@ private:
     bool isTargetReached();
     bool isEffectiveTargetReached();
     bool shouldStartPulsing();
-    uint16_t getCurrentPulseOnTime() const;
+    uint16_t getCurrentPulseOnTime(float dispensed) const;
+    void startContinuous();
+    bool isMotorActiveState() const;  // States where the motor may be commanded on
+    uint32_t getActualOnTime() const;  // ms - real duration of the last motor-on period
+    float getStopPoint() const;          // kg - dispensed amount at which to stop (target - predicted in-flight)
+    void measureInflight();
+    void resetFlowCheck();
+    void recordFlowCycle(float grams, uint32_t onMs);
+    bool checkFlowWindow();              // Close a continuous-run window when due; true = flow collapsed
+    bool isFlowCollapsed() const;
 };
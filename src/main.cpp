@@ -28,6 +28,7 @@
 #include "faults/FaultDetector.h"
 
 // Communication
+#include "communication/SerialLink.h"
 #include "communication/SerialProtocol.h"
 #include "communication/StatusReporter.h"
 
@@ -65,6 +66,7 @@ FaultManager faultManager;
 FaultDetector faultDetector;
 
 // Communication
+SerialLink serialLink;
 SerialProtocol serialProtocol;
 StatusReporter statusReporter;
 
@@ -81,10 +83,10 @@ SerialOTAReceiver serialOTAReceiver;
 // TIMING VARIABLES
 // ============================================================================
 
-unsigned long lastSensorRead = 0;
-unsigned long lastScheduleCheck = 0;
+uint32_t lastSensorSecond = 0;     // RTC second of the last sensor read
 unsigned long lastFaultCheck = 0;
 unsigned long lastStatusReport = 0;
+unsigned long lastProgressReport = 0;
 
 // ============================================================================
 // SYSTEM MODE
@@ -104,8 +106,8 @@ inline SystemMode getSystemMode() {
 // CALLBACK HANDLERS
 // ============================================================================
 
-void onFeedingComplete() {
-    // Called when feeding cooldown completes
+void onFeedingFinished() {
+    // Called as soon as the FSM captured the final weight (start of cooldown)
     FeedingResult result = feedingFSM.getLastResult();
     float amount = feedingFSM.getDispensedAmount();
     FeedingTrigger trigger = feedingFSM.getTrigger();
@@ -114,32 +116,60 @@ void onFeedingComplete() {
     char timestamp[32];
     rtcManager.getTimestamp(timestamp, sizeof(timestamp));
 
-    // Only log to Serial2 when not in OTA mode — logger writes directly to the wire
+    FeedingReport report;
+    report.trigger = trigger;
+    report.result = result;
+    report.amount = amount;
+    report.pulseCycles = feedingFSM.getPulseCycles();
+    report.durationMs = feedingFSM.getFeedDuration();
+
+    MotorSenseStats sense = motorController.getSenseStats();
+    report.senseEdges = sense.edges;
+    if (sense.commandedOnMs > 0) {
+        report.senseDutyPct = min<uint32_t>(100, sense.senseActiveMs * 100 / sense.commandedOnMs);
+    }
+
+    // Only log to Serial2 when not in OTA mode — the OTA master reads every line it gets
     if (getSystemMode() == SystemMode::NORMAL) {
-        feedingLogger.logFeeding(trigger, amount, result, timestamp);
+        feedingLogger.sendProgress(feedingFSM.getProgress());  // Final snapshot closes the live view
+        feedingLogger.logFeeding(report, timestamp);
     }
 
-    Serial.printf("[FEEDING] Complete: trigger=%d, amount=%.3f kg, result=%d\n",
-                  trigger, amount, result);
+    Serial.printf("[FEEDING] Finished: trigger=%d, amount=%.3f kg, result=%d, cycles=%u, duration=%lu ms\n",
+                  trigger, amount, result, report.pulseCycles, report.durationMs);
 
     // Check for motor stuck fault (timeout with insufficient food dispensed)
     // Motor stuck if: timeout AND dispensed less than 50g (reasonable minimum for 10s runtime)
-    if (result == RESULT_TIMEOUT) {
-        Serial.printf("[FAULT] Motor stuck detected: timeout with only %.3f kg dispensed\n", amount);
+    if (result == RESULT_TIMEOUT || result == RESULT_NO_FLOW) {
+        Serial.printf("[FAULT] Motor stuck detected: %s with only %.3f kg dispensed\n",
+                      result == RESULT_NO_FLOW ? "flow collapse" : "timeout", amount);
         faultManager.setFault(FAULT_MOTOR_STUCK, "Motor Stuck/No Food Flow", amount);
-
-        // Force send status immediately so WiFi ESP gets the fault notification
         statusReporter.updateFaults(faultManager.getActiveFaults());
-        if (getSystemMode() == SystemMode::NORMAL) {
-            statusReporter.forceSend();
-            Serial.println("[FAULT] Motor stuck status sent to WiFi ESP");
-        }
+    } else if (result == RESULT_MOTOR_STALL) {
+        // FAULT_MOTOR_STUCK was already raised from the loop when the sense fault latched
+        Serial.printf("[FAULT] Feed aborted on motor sense fault after %.3f kg\n", amount);
     } else if (result == RESULT_SUCCESS) {
         // Clear motor stuck fault only on successful feeding
         faultManager.clearFault(FAULT_MOTOR_STUCK);
     }
     // Note: Don't clear on timeout - let user manually clear or retry feeding
 
+    // Push isFeeding=false, lastFeedComplete and any fault change immediately
+    statusReporter.updateFeedingState(false, result);
+    if (getSystemMode() == SystemMode::NORMAL) {
+        statusReporter.forceSend();
+    }
+}
+
+void onFeedingComplete() {
+    // Called when feeding cooldown completes (outcome was reported by onFeedingFinished)
+
+    // Persist what the dispense model learned during pulse-and-weigh (one NVS write per feed);
+    // the in-flight measurement lands during cooldown, so this waits until now
+    if (feedingFSM.getTrigger() == TRIGGER_SCHEDULE) {
+        prefsManager.saveDispenseModel(feedingFSM.getDispenseModelState());
+    }
+
     // Reset lastFeedComplete to RESULT_NONE after cooldown
     // This allows the next feeding to be properly reported
     statusReporter.updateFeedingState(false, RESULT_NONE);
@@ -154,12 +184,13 @@ void onNameUpdate(const char* name) {
     Serial.printf("[MAIN] Display name updated and saved: %s\n", name);
 }
 
-void onCommand(const char* command) {
-    Serial.printf("[CMD] Received command: '%s'\n", command);
+void onCommand(CommandId command, const CommandArgs& args) {
+    // Arguments and the allowed mode (e.g. no TARE while feeding) were already
+    // checked against the command table by the dispatcher
+    Serial.printf("[CMD] Received command: %s\n", CommandDispatcher::getSpec(command).name);
 
-    if (strcmp(command, "FEED_NOW") == 0) {
-        Serial.println("[CMD] Processing FEED_NOW");
-        if (!feedingFSM.isFeeding()) {
+    switch (command) {
+        case CMD_FEED_NOW: {
             bool success = feedingFSM.startFeeding(TRIGGER_MANUAL, FEEDING_MANUAL_TARGET);
             if (success) {
                 Serial.println("[CMD] Feeding started");
@@ -174,19 +205,16 @@ void onCommand(const char* command) {
                 delay(100);  // Small delay to ensure message is sent
                 statusReporter.updateFeedingState(false, RESULT_NONE);
             }
-        } else {
-            Serial.println("[CMD] Already feeding - ignored");
-        }
-    }
-    else if (strcmp(command, "STOP") == 0) {
-        Serial.println("[CMD] Processing STOP");
-        if (feedingFSM.isFeeding()) {
-            feedingFSM.stopFeeding(RESULT_ERROR);
+            break;
         }
-    }
-    else if (strcmp(command, "TARE") == 0) {
-        Serial.println("[CMD] Processing TARE");
-        if (!feedingFSM.isFeeding()) {
+
+        case CMD_STOP:
+            if (feedingFSM.isFeeding()) {
+                feedingFSM.stopFeeding(RESULT_ERROR);
+            }
+            break;
+
+        case CMD_TARE:
             if (weightSensor.tare()) {
                 long offset = weightSensor.getTareOffset();
                 prefsManager.saveTareOffset(offset);
@@ -194,35 +222,32 @@ void onCommand(const char* command) {
             } else {
                 Serial.println("[CMD] Tare failed");
             }
-        } else {
-            Serial.println("[CMD] Cannot tare while feeding");
+            break;
+
+        case CMD_RESET_FLOW:
+            flowSensor.resetDaily(rtcManager.getDayOfMonth());
+            prefsManager.saveWaterFlow(0.0f);  // Save reset to flash
+            Serial.println("[CMD] Flow reset saved to flash");
+            break;
+
+        case CMD_OTA_START: {
+            // Format: OTA_START:<totalBytes>[:<crc32>]
+            size_t totalSize = args.num[0];
+            uint32_t crc = args.count > 1 ? args.num[1] : 0;
+            Serial.printf("[CMD] OTA update requested: %u bytes, CRC=0x%08X\n", totalSize, crc);
+            serialLink.setMode(LINK_ASCII);  // OTA receiver speaks raw lines
+            serialProtocol.releaseSerial();  // Stop parsing Serial2 before OTA chunks arrive
+            serialOTAReceiver.startOTA(totalSize, crc);
+            break;
         }
-    }
-    else if (strcmp(command, "RESET_FLOW") == 0) {
-        Serial.println("[CMD] Resetting flow sensor");
-        flowSensor.resetDaily(rtcManager.getDayOfMonth());
-        prefsManager.saveWaterFlow(0.0f);  // Save reset to flash
-        Serial.println("[CMD] Flow reset saved to flash");
-    }
-    else if (strcmp(command, "CLEAR_FAULTS") == 0) {
-        Serial.println("[CMD] Clearing all faults");
-        faultManager.clearAllFaults();
-    }
-    else if (strcmp(command, "GET_SCHEDULE_STATUS") == 0) {
-        Serial.println("[CMD] Sending schedule status");
-        scheduleManager.sendScheduleStatus();
-    }
-    else if (strncmp(command, "OTA_START:", 10) == 0) {
-        // Format: OTA_START:<totalBytes>:<crc32>
-        const char* rest = command + 10;
-        char* colon = strchr(rest, ':');
-        size_t totalSize = (size_t)atoi(rest);
-        uint32_t crc = colon ? (uint32_t)strtoul(colon + 1, nullptr, 10) : 0;
-        Serial.printf("[CMD] OTA update requested: %u bytes, CRC=0x%08X\n", totalSize, crc);
-        serialOTAReceiver.startOTA(totalSize, crc);
-    }
-    else {
-        Serial.printf("[CMD] Unknown command: '%s'\n", command);
+
+        case CMD_STATUS_KEYFRAME:
+            statusReporter.requestKeyframe();  // Goes out with the next status tick
+            break;
+
+        default:
+            Serial.printf("[CMD] Unhandled command: %s\n", CommandDispatcher::getSpec(command).name);
+            break;
     }
 }
 
@@ -238,10 +263,19 @@ void setup() {
     Serial.println("=================================\n");
 
     // Initialize Serial2 for WiFi ESP communication
-    Serial2.setRxBufferSize(4096);  // Increase RX buffer for large JSON payloads
+    Serial2.setRxBufferSize(4096);  // Absorbs schedule syncs while the loop is busy (NVS writes, I2C)
+    Serial2.setTxBufferSize(SERIAL2_TX_BUFFER);  // Driver drains it from the UART interrupt
     Serial2.begin(SERIAL2_BAUD, SERIAL_8N1, RXD2, TXD2);
     Serial.println("[INIT] Serial2 initialized (115200 baud, 4096 byte RX buffer)");
 
+    // Everything sent to the WiFi ESP goes through the link (ASCII until LINK:BINARY)
+    statusReporter.setLink(&serialLink);
+    feedingLogger.setLink(&serialLink);
+    faultManager.setLink(&serialLink);
+    scheduleManager.setLink(&serialLink);
+    serialProtocol.setLink(&serialLink);
+    serialOTAReceiver.setLink(&serialLink);
+
     // Initialize weight sensor
     Serial.print("[INIT] Initializing weight sensor...");
     if (weightSensor.begin(SCALE_DOUT_PIN, SCALE_CLK_PIN, SCALE_CALIBRATION_FACTOR)) {
@@ -277,7 +311,7 @@ void setup() {
 
     // Initialize RTC
     Serial.print("[INIT] Initializing RTC...");
-    if (rtcManager.begin()) {
+    if (rtcManager.begin(RTC_SQW_PIN)) {
         Serial.println(" OK");
         char timestamp[32];
         rtcManager.getTimestamp(timestamp, sizeof(timestamp));
@@ -318,13 +352,17 @@ void setup() {
     // Initialize feeding state machine
     Serial.print("[INIT] Initializing feeding FSM...");
     feedingFSM.begin(&motorController, &weightSensor);
+    feedingFSM.setFinishCallback(onFeedingFinished);
     feedingFSM.setCooldownCallback(onFeedingComplete);
+    DispenseModelState dispenseModel;
+    if (prefsManager.loadDispenseModel(dispenseModel)) {
+        feedingFSM.setDispenseModelState(dispenseModel);
+    }
     Serial.println(" OK");
 
     // Initialize schedule manager
     Serial.print("[INIT] Initializing schedule manager...");
-    scheduleManager.begin(&rtcManager);
-    scheduleManager.loadFromFlash();
+    scheduleManager.begin(&rtcManager);  // Loads cached schedules from flash
     Serial.println(" OK");
 
     // Initialize fault detector
@@ -365,23 +403,49 @@ void loop() {
         serialOTAReceiver.tick();
     } else {
         serialProtocol.processIncoming();
+        scheduleManager.pumpReports();  // Paced digest / status dump lines
     }
 
+    // Top up the UART TX buffer from the priority queues (never blocks)
+    serialLink.pump();
+
+    // ========================================================================
+    // HIGH PRIORITY: Buffer HX711 sample if one is ready (non-blocking)
+    // ========================================================================
+    weightSensor.update();
+
     // ========================================================================
     // HIGH PRIORITY: Update feeding state machine (non-blocking)
     // ========================================================================
     feedingFSM.update();
 
     // ========================================================================
-    // HIGH PRIORITY: Update motor controller (non-blocking FSM)
+    // HIGH PRIORITY: Update motor controller (pulse edges come from its timer;
+    // this only drives pulsing if the timer could not be created)
     // ========================================================================
     motorController.update();
 
+    // Motor sense fault latched (stall or relay/sense mismatch): alert immediately
+    static MotorSenseFault lastSenseFault = MOTOR_SENSE_OK;
+    MotorSenseFault senseFault = motorController.getSenseFault();
+    if (senseFault != lastSenseFault) {
+        lastSenseFault = senseFault;
+        if (senseFault != MOTOR_SENSE_OK) {
+            faultManager.setFault(FAULT_MOTOR_STUCK,
+                                  senseFault == MOTOR_SENSE_STALL ? "Motor Stall (sense)" : "Motor Run-On (sense)");
+            statusReporter.updateFaults(faultManager.getActiveFaults());
+            if (getSystemMode() == SystemMode::NORMAL) {
+                statusReporter.forceSend();
+            }
+        }
+    }
+
     // ========================================================================
-    // MEDIUM PRIORITY: Read sensors (every 1 second)
+    // MEDIUM PRIORITY: Read sensors (once per RTC second - SQW aligned)
     // ========================================================================
-    if (getSystemMode() == SystemMode::NORMAL && currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL_MS) {
-        lastSensorRead = currentMillis;
+    uint32_t rtcSecond = rtcManager.getEpoch();
+    if (getSystemMode() == SystemMode::NORMAL && rtcSecond != lastSensorSecond) {
+        lastSensorSecond = rtcSecond;
 
         // Update flow sensor
         flowSensor.update();
@@ -416,6 +480,13 @@ void loop() {
         // Update faults
         statusReporter.updateFaults(faultManager.getActiveFaults());
 
+        // Update Serial2 link health
+        SerialRxStats rxStats = serialProtocol.getRxStats();
+        LinkSpeedStats speedStats = serialProtocol.getSpeedStats();
+        statusReporter.updateLinkHealth(serialLink.getBaud(),
+                                        rxStats.errors + rxStats.frameErrors,
+                                        speedStats.failures + speedStats.fallbacks);
+
         // Update LCD display
         char timestamp[32];
         rtcManager.getTimestamp(timestamp, sizeof(timestamp));
@@ -423,12 +494,10 @@ void loop() {
     }
 
     // ========================================================================
-    // MEDIUM PRIORITY: Check schedules (every 10 seconds)
+    // MEDIUM PRIORITY: Check schedules (O(1) next-due compare against the RTC epoch)
     // ========================================================================
-    if (getSystemMode() == SystemMode::NORMAL && currentMillis - lastScheduleCheck >= SCHEDULE_CHECK_INTERVAL_MS) {
-        lastScheduleCheck = currentMillis;
-
-        if (!feedingFSM.isFeeding() && rtcManager.isValid()) {
+    if (getSystemMode() == SystemMode::NORMAL) {
+        if (!feedingFSM.isFeeding()) {
             float amount = 0;
             if (scheduleManager.checkSchedules(amount)) {
                 Serial.printf("[SCHEDULE] Matched! Amount: %.3f kg\n", amount);
@@ -472,6 +541,15 @@ void loop() {
         faultDetector.checkAll();
     }
 
+    // ========================================================================
+    // MEDIUM PRIORITY: Live feed progress while feeding
+    // ========================================================================
+    if (getSystemMode() == SystemMode::NORMAL && feedingFSM.isFeeding() &&
+        currentMillis - lastProgressReport >= FEED_PROGRESS_INTERVAL_MS) {
+        lastProgressReport = currentMillis;
+        feedingLogger.sendProgress(feedingFSM.getProgress());
+    }
+
     // ========================================================================
     // LOW PRIORITY: Send status updates (delta-based or 5-minute heartbeat)
     // ========================================================================
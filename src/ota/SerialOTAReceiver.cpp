@@ -1,4 +1,5 @@
 #include "SerialOTAReceiver.h"
+#include "../communication/SerialLink.h"
 #include <Update.h>
 #include <esp_task_wdt.h>
 
@@ -7,10 +8,14 @@
 // ============================================================================
 
 SerialOTAReceiver::SerialOTAReceiver()
-    : receiving_(false), updateBegun_(false),
+    : link_(nullptr), receiving_(false), updateBegun_(false),
       totalSize_(0), expectedCRC_(0), expectedSeq_(0),
       lastActivityMs_(0), lineIdx_(0) {}
 
+void SerialOTAReceiver::setLink(SerialLink* link) {
+    link_ = link;
+}
+
 // ============================================================================
 // START OTA — called from onCommand() in main.cpp
 // ============================================================================
@@ -26,7 +31,7 @@ void SerialOTAReceiver::startOTA(size_t totalSize, uint32_t expectedCRC) {
 
     if (!Update.begin(totalSize_)) {
         Serial.printf("[OTA] Update.begin() failed — not enough OTA partition space\n");
-        Serial2.println("OTA_ERROR:no_space");
+        send("OTA_ERROR:no_space");
         return;
     }
 
@@ -36,12 +41,12 @@ void SerialOTAReceiver::startOTA(size_t totalSize, uint32_t expectedCRC) {
 
     // Drain any queued outgoing status/fault messages before sending OTA_READY,
     // so the Master doesn't read a stale JSON frame instead of OTA_READY.
-    Serial2.flush();
+    flushOutput();
 
     // Flush any leftover incoming bytes from normal protocol traffic
     while (Serial2.available()) Serial2.read();
 
-    Serial2.println("OTA_READY");
+    send("OTA_READY");
     Serial.println("[OTA] Sent OTA_READY, waiting for chunks...");
 }
 
@@ -139,7 +144,7 @@ void SerialOTAReceiver::handleChunk(const char* line) {
         Serial.printf("[OTA] Seq mismatch: expected %d, got %d\n", expectedSeq_, seq);
         char nack[24];
         snprintf(nack, sizeof(nack), "OTA_NACK:%d", seq);
-        Serial2.println(nack);
+        send(nack);
         return;
     }
 
@@ -149,7 +154,7 @@ void SerialOTAReceiver::handleChunk(const char* line) {
         Serial.printf("[OTA] Hex length mismatch: expected %u, got %u\n", len * 2, hexLen);
         char nack[24];
         snprintf(nack, sizeof(nack), "OTA_NACK:%d", seq);
-        Serial2.println(nack);
+        send(nack);
         return;
     }
 
@@ -170,7 +175,7 @@ void SerialOTAReceiver::handleChunk(const char* line) {
     // Send ACK
     char ack[24];
     snprintf(ack, sizeof(ack), "OTA_ACK:%d", seq);
-    Serial2.println(ack);
+    send(ack);
     expectedSeq_++;
 
     // Progress every 50 chunks
@@ -188,7 +193,7 @@ void SerialOTAReceiver::handleEnd() {
 
     if (!Update.end()) {
         Serial.printf("[OTA] Update.end() failed: %s\n", Update.errorString());
-        Serial2.println("OTA_ERROR:end_fail");
+        send("OTA_ERROR:end_fail");
         receiving_ = false;
         updateBegun_ = false;
         return;
@@ -196,19 +201,35 @@ void SerialOTAReceiver::handleEnd() {
 
     if (!Update.isFinished()) {
         Serial.println("[OTA] Update not finished (incomplete write?)");
-        Serial2.println("OTA_ERROR:not_finished");
+        send("OTA_ERROR:not_finished");
         receiving_ = false;
         updateBegun_ = false;
         return;
     }
 
     Serial.println("[OTA] Firmware verified — rebooting!");
-    Serial2.println("OTA_OK");
-    Serial2.flush();
+    send("OTA_OK");
+    flushOutput();
     delay(500);
     ESP.restart();
 }
 
+// ============================================================================
+// OUTPUT (through the link's urgent queue)
+// ============================================================================
+
+void SerialOTAReceiver::send(const char* line) {
+    if (link_) {
+        link_->sendLine(line, LINK_PRIO_URGENT);
+    }
+}
+
+void SerialOTAReceiver::flushOutput() {
+    if (link_) {
+        link_->flush();
+    }
+}
+
 // ============================================================================
 // ABORT
 // ============================================================================
@@ -217,7 +238,7 @@ void SerialOTAReceiver::abort(const char* reason) {
     Serial.printf("[OTA] Aborted: %s\n", reason);
     char msg[48];
     snprintf(msg, sizeof(msg), "OTA_ERROR:%s", reason);
-    Serial2.println(msg);
+    send(msg);
 
     if (updateBegun_) {
         Update.abort();
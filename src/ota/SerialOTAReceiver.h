@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+class SerialLink;
+
 // ============================================================================
 // SERIAL OTA RECEIVER
 // ============================================================================
@@ -30,6 +32,9 @@ class SerialOTAReceiver {
 public:
     SerialOTAReceiver();
 
+    // Send replies through the Serial2 TX queue (main loop keeps pumping it during OTA)
+    void setLink(SerialLink* link);
+
     // Called from onCommand() when OTA_START:<size>:<crc32> arrives.
     // Sends OTA_READY back and activates receiving mode.
     void startOTA(size_t totalSize, uint32_t expectedCRC);
@@ -41,6 +46,7 @@ public:
     bool isReceiving() const { return receiving_; }
 
 private:
+    SerialLink* link_;
     bool receiving_;
     bool updateBegun_;
     size_t totalSize_;
@@ -61,6 +67,8 @@ private:
     void handleChunk(const char* line);
     void handleEnd();
     void abort(const char* reason);
+    void send(const char* line);
+    void flushOutput();
 
     // Decodes uppercase hex string into buf, returns number of bytes written.
     size_t hexToBytes(const char* hex, size_t hexLen, uint8_t* buf);
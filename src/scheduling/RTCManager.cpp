@@ -1,4 +1,12 @@
 #include "RTCManager.h"
+#include "../config/CalibrationConfig.h"
+#include <esp_timer.h>
+
+#define US_PER_SECOND 1000000LL
+#define DISCIPLINE_STEP_US 100000LL   // Drift/slew applied in 100 ms steps
+
+// Static members
+RTCManager* RTCManager::instance_ = nullptr;
 
 // ============================================================================
 // CONSTRUCTOR
@@ -6,29 +14,69 @@
 
 RTCManager::RTCManager()
     : initialized_(false),
-      lastValidTime_(DateTime(2020, 1, 1, 0, 0, 0)) {
+      sqwPin_(0),
+      sqwTicks_(0),
+      sqwEdgeUs_(0),
+      anchorTick_(0),
+      anchorEpoch_(0),
+      anchorUs_(0),
+      lastVerifyUs_(0),
+      cachedEpoch_(0),
+      cachedTime_(DateTime(2020, 1, 1, 0, 0, 0)),
+      offsetUs_(0),
+      slewRemainingUs_(0),
+      lastDisciplineUs_(0),
+      driftPpm_(0),
+      driftValid_(false),
+      synced_(false),
+      baselineUs_(0),
+      baselineErrorUs_(0),
+      baselineUncertaintyUs_(0),
+      rtcStepsUs_(0),
+      lastOffsetMs_(0) {
+    anchorEpoch_ = cachedTime_.unixtime();
+    cachedEpoch_ = anchorEpoch_;
+    lock_ = portMUX_INITIALIZER_UNLOCKED;
+    instance_ = this;
 }
 
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
 
-bool RTCManager::begin() {
+bool RTCManager::begin(uint8_t sqwPin) {
     if (!rtc_.begin()) {
         initialized_ = false;
         return false;
     }
 
+    // 1 Hz square wave on SQW/INT (open-drain - needs the pull-up)
+    sqwPin_ = sqwPin;
+    rtc_.writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(sqwPin_, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(sqwPin_), sqwISR, FALLING);
+
     // Check if RTC lost power
     if (rtc_.lostPower()) {
         // Set to a default time (will be synced from WiFi ESP later)
         rtc_.adjust(DateTime(2020, 1, 1, 0, 0, 0));
     }
 
-    // Read initial time
-    lastValidTime_ = rtc_.now();
+    // Read initial time, anchored on a seconds rollover
+    anchorAligned();
     initialized_ = true;
 
+    // Drift learned on previous boots
+    preferences_.begin("rtc", true);  // Read-only
+    float drift = preferences_.getFloat("drift", NAN);
+    preferences_.end();
+    if (!isnan(drift)) {
+        driftPpm_ = drift;
+        driftValid_ = true;
+        Serial.printf("[RTC] Drift compensation: %.2f ppm\n", driftPpm_);
+    }
+    lastDisciplineUs_ = esp_timer_get_time();
+
     return true;
 }
 
@@ -37,46 +85,302 @@ bool RTCManager::begin() {
 // ============================================================================
 
 DateTime RTCManager::now() {
-    if (!initialized_) {
-        return lastValidTime_;
+    // Broken-down fields are recomputed once per second
+    uint32_t epoch = getEpoch();
+    if (epoch != cachedEpoch_) {
+        cachedEpoch_ = epoch;
+        cachedTime_ = DateTime(epoch);
     }
+    return cachedTime_;
+}
+
+uint32_t RTCManager::getEpoch() {
+    followTicks();
+
+    int64_t nowUs = esp_timer_get_time();
+    if (initialized_ && nowUs - lastVerifyUs_ >= RTC_VERIFY_INTERVAL * 1000LL) {
+        verify(nowUs);
+    }
+    if (nowUs - lastDisciplineUs_ >= DISCIPLINE_STEP_US) {
+        discipline(nowUs);
+    }
+    return epochAt(nowUs);
+}
+
+uint32_t RTCManager::epochAt(int64_t nowUs) const {
+    return (uint32_t)((rtcUsAt(nowUs) + (int64_t)offsetUs_) / US_PER_SECOND);
+}
+
+int64_t RTCManager::rtcUsAt(int64_t nowUs) const {
+    return (int64_t)anchorEpoch_ * US_PER_SECOND + (nowUs - anchorUs_);
+}
+
+// ============================================================================
+// ANCHORING
+// ============================================================================
+
+void RTCManager::verify(int64_t nowUs) {
+    // The read must not straddle an SQW edge: that edge would be counted once by
+    // observe() (the read shows the new second) and again by the next followTicks()
+    followTicks();
+    uint32_t ticksBefore = anchorTick_;
 
     DateTime current = rtc_.now();
 
-    // Validate time is reasonable (year > 2020)
-    if (current.year() >= 2020) {
-        lastValidTime_ = current;
-        return current;
+    portENTER_CRITICAL(&lock_);
+    uint32_t ticksAfter = sqwTicks_;
+    portEXIT_CRITICAL(&lock_);
+    if (ticksAfter != ticksBefore) {
+        return;  // Edge during the read - retry on the next query
     }
+    lastVerifyUs_ = nowUs;
 
-    return lastValidTime_;
+    // Validate time is reasonable (year > 2020) - otherwise keep running on the anchor
+    if (current.year() < 2020) {
+        Serial.println("[RTC] Invalid DS3231 read - keeping cached clock");
+        return;
+    }
+    observe(current.unixtime(), nowUs, ticksAfter);
+
+    // Whole seconds of accumulated correction go into the RTC itself
+    if (fabs(offsetUs_) >= US_PER_SECOND) {
+        Serial.printf("[RTC] Folding %+ld ms of correction into the DS3231\n", (long)(offsetUs_ / 1000));
+        stepTo(rtcUsAt(nowUs) + offsetUs_, nowUs);
+    }
+}
+
+void RTCManager::anchorAligned() {
+    DateTime first = rtc_.now();
+    int64_t startUs = esp_timer_get_time();
+    lastVerifyUs_ = startUs;
+
+    if (first.year() < 2020) {
+        return;  // Keep the default anchor; verification retries later
+    }
+
+    // Wait for the next SQW edge (or, without one, the seconds register rolling
+    // over) and anchor on it; the read after an edge lands in the new second
+    uint32_t startTicks = sqwTicks_;
+    while (esp_timer_get_time() - startUs < RTC_ALIGN_TIMEOUT * 1000LL) {
+        if (sqwTicks_ != startTicks) {
+            DateTime current = rtc_.now();
+            portENTER_CRITICAL(&lock_);
+            anchorTick_ = sqwTicks_;
+            anchorUs_ = sqwEdgeUs_;
+            portEXIT_CRITICAL(&lock_);
+            anchorEpoch_ = current.unixtime();
+            lastVerifyUs_ = anchorUs_;
+            Serial.println("[RTC] Anchored on SQW edge");
+            return;
+        }
+        DateTime current = rtc_.now();
+        if (current.unixtime() != first.unixtime()) {
+            anchorEpoch_ = current.unixtime();
+            anchorUs_ = esp_timer_get_time();
+            anchorTick_ = sqwTicks_;
+            lastVerifyUs_ = anchorUs_;
+            Serial.println("[RTC] No SQW edge - anchored on seconds register");
+            return;
+        }
+        delay(1);
+    }
+
+    // No rollover seen - anchor on the first read (sub-second phase unknown)
+    anchorEpoch_ = first.unixtime();
+    anchorUs_ = startUs;
+}
+
+void RTCManager::observe(uint32_t epoch, int64_t atUs, uint32_t ticks) {
+    // The RTC second `epoch` began somewhere in (atUs - 1 s, atUs]
+    int64_t start = anchorUs_ + ((int64_t)epoch - (int64_t)anchorEpoch_) * US_PER_SECOND;
+    int64_t corrected;
+    if (start > atUs) {
+        corrected = atUs;                       // Cached clock lagging
+    } else if (start <= atUs - US_PER_SECOND) {
+        corrected = atUs - US_PER_SECOND + 1;   // Cached clock leading
+    } else {
+        return;                                 // Consistent - keep phase
+    }
+
+    Serial.printf("[RTC] Cached clock off by %+ld ms - re-anchored\n", (long)((start - corrected) / 1000));
+    // Epoch and tick count move together, so followTicks() only adds later edges
+    anchorEpoch_ = epoch;
+    anchorTick_ = ticks;
+    anchorUs_ = corrected;
+}
+
+// ============================================================================
+// SQW TIME BASE
+// ============================================================================
+
+void IRAM_ATTR RTCManager::sqwISR() {
+    RTCManager* self = instance_;
+    if (!self) return;
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&self->lock_);
+    self->sqwTicks_++;
+    self->sqwEdgeUs_ = now;
+    portEXIT_CRITICAL_ISR(&self->lock_);
+}
+
+void RTCManager::followTicks() {
+    portENTER_CRITICAL(&lock_);
+    uint32_t ticks = sqwTicks_;
+    int64_t edgeUs = sqwEdgeUs_;
+    portEXIT_CRITICAL(&lock_);
+
+    if (ticks == anchorTick_) {
+        return;  // No new edge - esp_timer interpolates from the last one
+    }
+
+    // Each edge starts a new RTC second: move the anchor onto the newest edge
+    anchorEpoch_ += ticks - anchorTick_;
+    anchorTick_ = ticks;
+    anchorUs_ = edgeUs;
+}
+
+bool RTCManager::isSecondTickActive() {
+    portENTER_CRITICAL(&lock_);
+    uint32_t ticks = sqwTicks_;
+    int64_t edgeUs = sqwEdgeUs_;
+    portEXIT_CRITICAL(&lock_);
+    return ticks > 0 && esp_timer_get_time() - edgeUs < RTC_SQW_TIMEOUT * 1000LL;
 }
 
 // ============================================================================
 // TIME SYNCHRONIZATION
 // ============================================================================
 
-bool RTCManager::syncFromString(const char* timeString) {
+bool RTCManager::syncFromString(const char* timeString, uint32_t linkDelayUs) {
     if (!initialized_) {
         return false;
     }
 
-    // Parse time string: "YYYY-MM-DD HH:MM:SS"
-    int year, month, day, hour, minute, second;
-    if (!parseTimeString(timeString, year, month, day, hour, minute, second)) {
+    // Parse time string: "YYYY-MM-DD HH:MM:SS[.mmm]"
+    int year, month, day, hour, minute, second, millisecond;
+    bool hasMillis;
+    if (!parseTimeString(timeString, year, month, day, hour, minute, second, millisecond, hasMillis)) {
         return false;
     }
 
-    // Create DateTime object
-    DateTime newTime(year, month, day, hour, minute, second);
+    // Bring the local clock up to this instant
+    followTicks();
+    int64_t nowUs = esp_timer_get_time();
+    discipline(nowUs);
+
+    // Reference time now = stamp + time on the wire (a stamp without
+    // milliseconds was truncated - assume mid-second)
+    DateTime stamp(year, month, day, hour, minute, second);
+    double refUs = (double)stamp.unixtime() * US_PER_SECOND +
+                   (hasMillis ? millisecond * 1000.0 : US_PER_SECOND / 2) + linkDelayUs;
+    double rtcUs = (double)rtcUsAt(nowUs);
+    double offset = refUs - (rtcUs + offsetUs_);
+    uint32_t uncertaintyUs = hasMillis ? RTC_SYNC_STAMP_UNCERTAINTY : US_PER_SECOND / 2;
+    lastOffsetMs_ = (long)(offset / 1000);
+
+    // Drift of the RTC itself (before this sync corrects anything)
+    bool newBaseline = !synced_ || updateDrift(refUs - rtcUs, nowUs, uncertaintyUs);
+    if (newBaseline) {
+        synced_ = true;
+        baselineUs_ = nowUs;
+        baselineErrorUs_ = refUs - rtcUs;
+        baselineUncertaintyUs_ = uncertaintyUs;
+        rtcStepsUs_ = 0;
+    }
+
+    bool step = fabs(offset) >= RTC_STEP_THRESHOLD * 1000.0;
+    if (step) {
+        // Writing the seconds register restarts the DS3231 count - stepTo re-anchors
+        slewRemainingUs_ = 0;
+        stepTo(refUs, nowUs);
+    } else {
+        slewRemainingUs_ = offset;  // Replaces any unfinished slew (it is part of this offset)
+    }
+
+    Serial.printf("[RTC] Sync: offset %+ld ms (%s), link %lu us, drift %.2f ppm%s\n",
+                  lastOffsetMs_, step ? "stepped" : "slewing", (unsigned long)linkDelayUs,
+                  driftPpm_, driftValid_ ? "" : " (learning)");
+    return true;
+}
+
+// ============================================================================
+// DISCIPLINE
+// ============================================================================
+
+void RTCManager::discipline(int64_t nowUs) {
+    double dt = (double)(nowUs - lastDisciplineUs_);
+    lastDisciplineUs_ = nowUs;
+
+    // Drift compensation: ppm x us / 1e6 = us
+    if (driftValid_) {
+        offsetUs_ += driftPpm_ * dt / 1e6;
+    }
+
+    // Slew the outstanding sync offset in at a bounded rate (time never jumps)
+    if (slewRemainingUs_ != 0) {
+        double maxStep = RTC_SLEW_RATE_PPM * dt / 1e6;
+        double slew = constrain(slewRemainingUs_, -maxStep, maxStep);
+        offsetUs_ += slew;
+        slewRemainingUs_ -= slew;
+    }
+}
+
+void RTCManager::stepTo(double localUs, int64_t atUs) {
+    double oldRtcUs = (double)rtcUsAt(atUs);
+    uint32_t epoch = (uint32_t)((localUs + US_PER_SECOND / 2) / US_PER_SECOND);
+
+    rtc_.adjust(DateTime(epoch));
+    int64_t writeUs = esp_timer_get_time();
+
+    // The DS3231 count restarts at the write: anchor there, edges count from here
+    portENTER_CRITICAL(&lock_);
+    anchorTick_ = sqwTicks_;
+    portEXIT_CRITICAL(&lock_);
+    anchorEpoch_ = epoch;
+    anchorUs_ = writeUs;
+    lastVerifyUs_ = writeUs;
+
+    // Sub-second remainder stays in software; the step counts against the drift baseline
+    double elapsedUs = (double)(writeUs - atUs);
+    offsetUs_ = localUs + elapsedUs - (double)epoch * US_PER_SECOND;
+    rtcStepsUs_ += (double)epoch * US_PER_SECOND - (oldRtcUs + elapsedUs);
+}
+
+bool RTCManager::updateDrift(double errorUs, int64_t nowUs, uint32_t uncertaintyUs) {
+    // Both stamps' uncertainty must be small against the drift accumulated over the interval
+    double elapsedUs = (double)(nowUs - baselineUs_);
+    double needUs = (double)(uncertaintyUs + baselineUncertaintyUs_) * 1e6 / RTC_DRIFT_RESOLUTION_PPM;
+    if (elapsedUs < needUs) {
+        return false;  // Keep the baseline - a later sync measures over a longer interval
+    }
+
+    // A step of s moved the RTC error by -s, so add the steps back
+    float ppm = (errorUs - baselineErrorUs_ + rtcStepsUs_) / elapsedUs * 1e6;
+    if (fabs(ppm) > RTC_DRIFT_MAX_PPM) {
+        Serial.printf("[RTC] Drift %.1f ppm implausible - ignored\n", ppm);
+        return true;
+    }
 
-    // Adjust RTC
-    rtc_.adjust(newTime);
-    lastValidTime_ = newTime;
+    driftPpm_ = driftValid_ ? driftPpm_ + RTC_DRIFT_LEARN_ALPHA * (ppm - driftPpm_) : ppm;
+    driftValid_ = true;
 
+    preferences_.begin("rtc", false);
+    preferences_.putFloat("drift", driftPpm_);
+    preferences_.end();
+    Serial.printf("[RTC] Drift measured %.2f ppm over %lu s - now %.2f ppm\n",
+                  ppm, (unsigned long)(elapsedUs / 1e6), driftPpm_);
     return true;
 }
 
+float RTCManager::getDriftPpm() const {
+    return driftValid_ ? driftPpm_ : 0.0f;
+}
+
+long RTCManager::getLastSyncOffsetMs() const {
+    return lastOffsetMs_;
+}
+
 // ============================================================================
 // FORMATTED OUTPUT
 // ============================================================================
@@ -115,6 +419,22 @@ uint32_t RTCManager::getCurrentDate() {
     return (current.year() * 10000) + (current.month() * 100) + current.day();
 }
 
+uint16_t RTCManager::getDaySerial() {
+    return daySerial(now());
+}
+
+uint16_t RTCManager::daySerial(const DateTime& time) {
+    return time.unixtime() / 86400UL;
+}
+
+uint32_t RTCManager::daySerialToDate(uint16_t serial) {
+    if (serial == 0) {
+        return 0;
+    }
+    DateTime date((uint32_t)serial * 86400UL);
+    return (date.year() * 10000) + (date.month() * 100) + date.day();
+}
+
 // ============================================================================
 // VALIDATION
 // ============================================================================
@@ -137,17 +457,31 @@ bool RTCManager::needsSync() {
 // ============================================================================
 
 bool RTCManager::parseTimeString(const char* timeString, int& year, int& month, int& day,
-                                 int& hour, int& minute, int& second) {
-    // Expected format: "YYYY-MM-DD HH:MM:SS"
-    // Example: "2024-11-27 13:45:30"
+                                 int& hour, int& minute, int& second, int& millisecond, bool& hasMillis) {
+    // Expected format: "YYYY-MM-DD HH:MM:SS[.mmm]"
+    // Example: "2024-11-27 13:45:30" or "2024-11-27 13:45:30.250"
 
-    int parsed = sscanf(timeString, "%d-%d-%d %d:%d:%d",
-                       &year, &month, &day, &hour, &minute, &second);
+    int consumed = 0;
+    int parsed = sscanf(timeString, "%d-%d-%d %d:%d:%d%n",
+                       &year, &month, &day, &hour, &minute, &second, &consumed);
 
     if (parsed != 6) {
         return false;
     }
 
+    // Optional fraction (up to millisecond resolution)
+    millisecond = 0;
+    hasMillis = false;
+    const char* fraction = timeString + consumed;
+    if (*fraction == '.') {
+        int scale = 100;
+        for (fraction++; *fraction >= '0' && *fraction <= '9'; fraction++) {
+            millisecond += (*fraction - '0') * scale;
+            scale /= 10;
+        }
+        hasMillis = true;
+    }
+
     // Validate ranges
     if (year < 2020 || year > 2100) return false;
     if (month < 1 || month > 12) return false;
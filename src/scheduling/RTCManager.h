@@ -2,24 +2,47 @@
 
 #include <Arduino.h>
 #include <RTClib.h>
+#include <freertos/FreeRTOS.h>
+#include <Preferences.h>
 
 // ============================================================================
 // RTC MANAGER (DS3231)
 // ============================================================================
 // Manages DS3231 Real-Time Clock with time sync from WiFi ESP
+// Wall-clock service: the DS3231 is read once to anchor a unix epoch against
+// esp_timer, and every query is answered from RAM (broken-down DateTime cached
+// per second). A verification read every RTC_VERIFY_INTERVAL nudges the anchor
+// back onto the RTC's seconds, so queries cost no I2C traffic
+// Time base: the DS3231's 1 Hz SQW output is counted in an ISR and each falling
+// edge re-anchors the epoch, so seconds advance on true RTC boundaries;
+// esp_timer only interpolates within a second (or carries on if SQW stops)
+// Discipline: each TIME: sync measures the offset (after the line's transit
+// time) and the RTC's drift against the reference; small offsets are slewed
+// in, large ones stepped, and the persisted drift rate is compensated between
+// syncs so the clock holds through long WiFi outages
 
 class RTCManager {
 public:
     RTCManager();
 
-    // Initialize RTC
-    bool begin();
+    // Initialize RTC and its 1 Hz SQW time base
+    bool begin(uint8_t sqwPin);
 
-    // Get current time
+    // Get current time (cached - no I2C except the periodic verification read)
     DateTime now();
 
-    // Sync time from string (from WiFi ESP)
-    bool syncFromString(const char* timeString);  // Format: "YYYY-MM-DD HH:MM:SS"
+    // Current unix time in seconds (cheapest query - changes on the RTC's second boundary)
+    uint32_t getEpoch();
+
+    // True while SQW edges are arriving (seconds come from the RTC, not esp_timer)
+    bool isSecondTickActive();
+
+    // Sync time from string (from WiFi ESP); linkDelayUs = time the line spent on the wire
+    bool syncFromString(const char* timeString, uint32_t linkDelayUs = 0);  // "YYYY-MM-DD HH:MM:SS[.mmm]"
+
+    // Discipline state
+    float getDriftPpm() const;          // RTC rate error vs reference (+ = RTC runs slow), 0 until learned
+    long getLastSyncOffsetMs() const;   // Offset measured by the last sync (reference - local)
 
     // Get formatted timestamp
     void getTimestamp(char* buffer, size_t bufferSize);
@@ -30,6 +53,11 @@ public:
     int getDayOfWeek();  // 0=Sunday, 6=Saturday
     int getDayOfMonth();
     uint32_t getCurrentDate();  // Get current date in YYYYMMDD format
+    uint16_t getDaySerial();    // Days since 1970-01-01 (unix time / 86400)
+
+    // Day serial <-> date conversions (no RTC access)
+    static uint16_t daySerial(const DateTime& time);
+    static uint32_t daySerialToDate(uint16_t serial);  // YYYYMMDD, 0 for serial 0
 
     // Validation
     bool isValid();
@@ -38,9 +66,71 @@ public:
 private:
     RTC_DS3231 rtc_;
     bool initialized_;
-    DateTime lastValidTime_;
+    uint8_t sqwPin_;
+
+    // SQW tick capture (ISR-updated, guarded by lock_)
+    volatile uint32_t sqwTicks_;
+    volatile int64_t sqwEdgeUs_;
+    uint32_t anchorTick_;          // sqwTicks_ value anchorEpoch_ refers to
+    portMUX_TYPE lock_;
+    static RTCManager* instance_;
+    static void IRAM_ATTR sqwISR();
+
+    // Advance the anchor over SQW edges counted since the last query
+    void followTicks();
+
+    // Epoch anchor: RTC second anchorEpoch_ began at esp_timer time anchorUs_
+    uint32_t anchorEpoch_;
+    int64_t anchorUs_;
+    int64_t lastVerifyUs_;
+
+    // Broken-down time for the current second
+    uint32_t cachedEpoch_;
+    DateTime cachedTime_;
+
+    // Unix time at esp_timer time nowUs, from the anchor
+    uint32_t epochAt(int64_t nowUs) const;
+
+    // Read the DS3231 and pull the anchor onto its seconds
+    void verify(int64_t nowUs);
+
+    // Anchor on a seconds rollover of the DS3231 (blocks up to RTC_ALIGN_TIMEOUT)
+    void anchorAligned();
+
+    // Fold in "RTC showed epoch at atUs": moves the anchor only as far as the
+    // reading requires, so sub-second phase is kept between verifications;
+    // ticks = sqwTicks_ at the read (no edge may have arrived during it)
+    void observe(uint32_t epoch, int64_t atUs, uint32_t ticks);
+
+    // Discipline: local time = RTC time + offsetUs_
+    double offsetUs_;              // Software correction on top of the RTC (|x| < 1 s, folded into the RTC beyond)
+    double slewRemainingUs_;       // Part of the last sync offset not slewed in yet
+    int64_t lastDisciplineUs_;
+    float driftPpm_;               // Persisted in NVS ("rtc" namespace)
+    bool driftValid_;
+    Preferences preferences_;
+
+    // Drift baseline: the sync the next drift measurement is taken against
+    bool synced_;
+    int64_t baselineUs_;           // esp_timer time of the baseline sync
+    double baselineErrorUs_;       // Reference minus RTC at the baseline sync
+    uint32_t baselineUncertaintyUs_;
+    double rtcStepsUs_;            // RTC register steps since the baseline
+    long lastOffsetMs_;
+
+    // RTC time in microseconds at esp_timer time nowUs
+    int64_t rtcUsAt(int64_t nowUs) const;
+
+    // Apply drift compensation and slew for the time since the last call
+    void discipline(int64_t nowUs);
+
+    // Write the RTC to the nearest second of localUs; the remainder stays in offsetUs_
+    void stepTo(double localUs, int64_t atUs);
+
+    // Learn drift from the RTC error at this sync; false = interval too short (baseline kept)
+    bool updateDrift(double errorUs, int64_t nowUs, uint32_t uncertaintyUs);
 
     // Parse time string
     bool parseTimeString(const char* timeString, int& year, int& month, int& day,
-                        int& hour, int& minute, int& second);
+                        int& hour, int& minute, int& second, int& millisecond, bool& hasMillis);
 };
@@ -1,6 +1,48 @@
 #include "ScheduleManager.h"
 #include "RTCManager.h"
-#include <ArduinoJson.h>
+#include "../communication/SerialLink.h"
+#include "../config/TimingConfig.h"
+#include <rom/crc.h>
+
+// NVS layout version ("ver" key; absent = 1)
+//   1: "count" + "sched_%d" holding the legacy 20-byte struct (time string, float kg, YYYYMMDD)
+//   2: "count" + "sched_%d" holding the packed 8-byte Schedule
+//   3: "table" blob (header + packed Schedules, CRC32) + "exec" blob (executed-today bitset)
+//   4: as 3, Schedule gains a leading uint32 id (v3 entries load with id 0 until the next full sync)
+#define SCHEDULE_LAYOUT_VERSION 4
+
+// Packed v2/v3 record (Schedule without id)
+struct ScheduleV2 {
+    uint16_t minuteOfDay;
+    uint16_t amountGrams;
+    uint16_t lastExecutionDay;
+    uint8_t daysOfWeek;
+    uint8_t flags;
+};
+
+// FNV-1a 32-bit
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+// "table" blob header; schedules follow immediately
+struct ScheduleTableHeader {
+    uint8_t version;            // SCHEDULE_LAYOUT_VERSION
+    uint8_t entrySize;          // sizeof(Schedule) when written
+    uint16_t count;
+    uint32_t crc;               // crc32_le over the schedule entries
+};
+
+// Staging buffer for the table blob (static - too large for the loop task stack)
+static uint8_t tableBlob[sizeof(ScheduleTableHeader) + sizeof(Schedule) * MAX_SCHEDULES];
+
+// Legacy v1 record, kept only to migrate existing flash contents
+struct ScheduleV1 {
+    char time[6];               // "HH:MM"
+    uint8_t daysOfWeek;
+    float amount;               // kg
+    bool enabled;
+    uint32_t lastExecutionDate; // YYYYMMDD
+};
 
 // ============================================================================
 // CONSTRUCTOR
@@ -8,8 +50,23 @@
 
 ScheduleManager::ScheduleManager()
     : rtcManager_(nullptr),
+      link_(nullptr),
       scheduleCount_(0),
-      lastMatchedScheduleIndex_(-1) {
+      streamStartTime_(0),
+      lastMatchedScheduleIndex_(-1),
+      eventCount_(0),
+      nextEvent_(0),
+      anchored_(false),
+      anchorMillis_(0),
+      nextDueEpoch_(0),
+      executedDay_(0),
+      tableHash_(0),
+      digestCursor_(-1),
+      digestTableHash_(0),
+      statusCursor_(-1),
+      statusDay_(0),
+      statusWeekday_(0) {
+    memset(executedToday_, 0, sizeof(executedToday_));
 }
 
 // ============================================================================
@@ -23,98 +80,64 @@ void ScheduleManager::begin(RTCManager* rtcManager) {
     loadFromFlash();
 }
 
+void ScheduleManager::setLink(SerialLink* link) {
+    link_ = link;
+}
+
 // ============================================================================
 // SCHEDULE PARSING
 // ============================================================================
 
 bool ScheduleManager::parseSchedules(const char* jsonString) {
-    Serial.printf("[SCHEDULE] Parsing schedules, JSON length: %d\n", strlen(jsonString));
-    Serial.printf("[SCHEDULE] Free heap before parsing: %d bytes\n", ESP.getFreeHeap());
-
-    // Empty or null JSON - clear schedules
-    if (!jsonString || strlen(jsonString) == 0 || strcmp(jsonString, "{}") == 0) {
-        Serial.println("[SCHEDULE] Empty JSON - clearing schedules");
-        scheduleCount_ = 0;
-        saveToFlash();
-        sendHashConfirmation(0);
-        return true;
-    }
-
-    // Reject oversized JSON to prevent OOM
-    size_t jsonLen = strlen(jsonString);
-    const size_t capacity = 8192;
-    if (jsonLen >= capacity) {
-        Serial.printf("[SCHEDULE] JSON too large (%d bytes) - rejecting\n", jsonLen);
-        return false;
+    // Whole document already in memory - run it through the stream parser
+    beginStreamSync();
+    if (jsonString) {
+        while (*jsonString) {
+            streamSyncByte(*jsonString++);
+        }
     }
+    return endStreamSync();
+}
 
-    Serial.printf("[SCHEDULE] Attempting to allocate %d bytes for JSON parsing\n", capacity);
+void ScheduleManager::beginStreamSync() {
+    Serial.println("[SCHEDULE] Receiving schedules (streaming)");
+    parser_.begin(staging_, MAX_SCHEDULES);
+    streamStartTime_ = millis();
+}
 
-    DynamicJsonDocument doc(capacity);
-    DeserializationError error = deserializeJson(doc, jsonString);
+void ScheduleManager::streamSyncByte(char c) {
+    parser_.feed(c);
+}
 
-    if (error) {
-        Serial.printf("[SCHEDULE] JSON parse error: %s\n", error.c_str());
-        Serial.printf("[SCHEDULE] Free heap after error: %d bytes\n", ESP.getFreeHeap());
+bool ScheduleManager::endStreamSync() {
+    if (parser_.finish() != ScheduleStreamParser::STREAM_COMPLETE) {
+        // Staging is discarded - the active table is untouched
+        Serial.println("[SCHEDULE] JSON parse error - keeping current schedules");
         return false;
     }
 
-    Serial.println("[SCHEDULE] JSON parsed successfully");
+    // Digest was accumulated during reception - confirm first, before the
+    // per-entry logging, index rebuild and the slow NVS erase + write
+    bool empty = parser_.isEmptyDocument();
+    sendHashConfirmation(empty ? 0 : parser_.getHash());
 
-    // Clear existing schedules
-    scheduleCount_ = 0;
-
-    // Parse each schedule
-    JsonObject root = doc.as<JsonObject>();
-    for (JsonPair kv : root) {
-        if (scheduleCount_ >= MAX_SCHEDULES) {
-            Serial.println("[SCHEDULE] Max schedules reached - skipping remaining");
-            break;
-        }
-
-        JsonObject scheduleObj = kv.value().as<JsonObject>();
-
-        // Extract fields
-        const char* time = scheduleObj["time"];
-        JsonArray daysArray = scheduleObj["days"];  // Array of days [0,1,2,3,4,5,6]
-        float amount = scheduleObj["amount"];
-        bool enabled = scheduleObj["enabled"] | true;  // Default true
-
-        // Convert amount from grams to kg
-        float amountKg = amount / 1000.0f;
-
-        if (time && daysArray.size() > 0 && amount > 0) {
-            // Convert days array to bitmask
-            uint8_t daysBitmask = 0;
-            for (JsonVariant dayVariant : daysArray) {
-                int day = dayVariant.as<int>();
-                if (day >= 0 && day <= 6) {
-                    daysBitmask |= (1 << day);  // Set bit for this day
-                }
-            }
-
-            // Store ONE schedule (not expanded per day)
-            Schedule& schedule = schedules_[scheduleCount_];
-            strncpy(schedule.time, time, 5);
-            schedule.time[5] = '\0';
-            schedule.daysOfWeek = daysBitmask;
-            schedule.amount = amountKg;
-            schedule.enabled = enabled;
-            schedule.lastExecutionDate = 0;  // Not executed yet
-
-            Serial.printf("[SCHEDULE] Parsed #%d: time=%s, days=0x%02X, amount=%.3f kg, enabled=%d\n",
-                          scheduleCount_, schedule.time, schedule.daysOfWeek, schedule.amount, schedule.enabled);
-
-            scheduleCount_++;
-        }
+    if (empty) {
+        Serial.println("[SCHEDULE] Empty JSON - clearing schedules");
     }
 
-    Serial.printf("[SCHEDULE] Total schedules parsed: %d\n", scheduleCount_);
+    scheduleCount_ = parser_.getCount();
+    memcpy(schedules_, staging_, scheduleCount_ * sizeof(Schedule));
+    for (int i = 0; i < scheduleCount_; i++) {
+        const Schedule& schedule = schedules_[i];
+        Serial.printf("[SCHEDULE] Parsed #%d: time=%02u:%02u, days=0x%02X, amount=%u g, enabled=%d\n",
+                      i, schedule.minuteOfDay / 60, schedule.minuteOfDay % 60,
+                      schedule.daysOfWeek, schedule.amountGrams, schedule.isEnabled());
+    }
 
-    // Calculate and send hash BEFORE flash write so WiFi ESP gets the
-    // confirmation immediately, without waiting for the slow NVS erase
-    unsigned long hash = calculateHash(jsonString);
-    sendHashConfirmation(hash);
+    Serial.printf("[SCHEDULE] Total schedules parsed: %d (%lu ms)\n",
+                  scheduleCount_, millis() - streamStartTime_);
+    rebuildIndex();
+    recomputeTableHash();
 
     // Save to flash (slow NVS erase + write - happens after confirmation sent)
     saveToFlash();
@@ -122,42 +145,186 @@ bool ScheduleManager::parseSchedules(const char* jsonString) {
     return true;
 }
 
+void ScheduleManager::abortStreamSync() {
+    Serial.println("[SCHEDULE] Schedule stream timed out - keeping current schedules");
+    parser_.begin(staging_, MAX_SCHEDULES);
+}
+
 // ============================================================================
 // SCHEDULE CHECKING
 // ============================================================================
 
 bool ScheduleManager::checkSchedules(float& amount) {
-    if (!rtcManager_ || scheduleCount_ == 0) {
+    if (!rtcManager_) {
         return false;
     }
 
-    // Check each schedule
-    for (int i = 0; i < scheduleCount_; i++) {
-        if (scheduleMatches(schedules_[i])) {
-            amount = schedules_[i].amount;
-            lastMatchedScheduleIndex_ = i;  // Store which schedule matched
-            return true;  // Caller must call confirmScheduleCompleted() if feed starts
+    // Anchor after a schedule/time change (retried while the RTC is invalid)
+    if (!anchored_ && millis() - anchorMillis_ >= SCHEDULE_INVALID_RTC_RETRY_MS) {
+        anchor(rtcManager_->now());
+    }
+
+    if (!anchored_ || eventCount_ == 0 || rtcManager_->getEpoch() < nextDueEpoch_) {
+        return false;  // Nothing due - cached epoch compare only
+    }
+
+    // Due: confirm the minute of week
+    DateTime now = rtcManager_->now();
+    refreshExecutedDay(now);
+    uint16_t mow = minuteOfWeek(now);
+
+    if (events_[nextEvent_].minuteOfWeek != mow) {
+        // Clock stepped or the minute passed while busy - realign
+        Serial.printf("[SCHEDULE] Due event at minute %u, RTC at %u - re-anchoring\n",
+                      events_[nextEvent_].minuteOfWeek, mow);
+        anchor(now);
+        return false;
+    }
+
+    // Several schedules can share a minute - first one not yet executed today wins
+    int i = nextEvent_;
+    for (; i < eventCount_ && events_[i].minuteOfWeek == mow; i++) {
+        int idx = events_[i].schedule;
+        if (!isExecutedToday(idx)) {
+            amount = schedules_[idx].amountKg();
+            lastMatchedScheduleIndex_ = idx;  // Caller must call confirmScheduleCompleted() if feed starts
+            nextDueEpoch_ = now.unixtime() + SCHEDULE_RETRY_INTERVAL_MS / 1000;  // Retry while the minute lasts
+            Serial.printf("[SCHEDULE] MATCH FOUND! %02u:%02u on day %d (day=%u)\n",
+                          schedules_[idx].minuteOfDay / 60, schedules_[idx].minuteOfDay % 60,
+                          now.dayOfTheWeek(), executedDay_);
+            return true;
         }
     }
 
+    // Everything at this minute is done - arm the following event
+    nextEvent_ = (i < eventCount_) ? i : 0;
+    armNextDue(now, true);
     return false;
 }
 
 void ScheduleManager::confirmScheduleCompleted() {
-    // Mark schedule as executed for today
-    if (rtcManager_ && lastMatchedScheduleIndex_ >= 0 && lastMatchedScheduleIndex_ < scheduleCount_) {
-        uint32_t today = rtcManager_->getCurrentDate();
-        schedules_[lastMatchedScheduleIndex_].lastExecutionDate = today;
+    // Mark schedule as executed for today (date from the RTC read that matched it)
+    if (lastMatchedScheduleIndex_ >= 0 && lastMatchedScheduleIndex_ < scheduleCount_) {
+        schedules_[lastMatchedScheduleIndex_].lastExecutionDay = executedDay_;
+        executedToday_[lastMatchedScheduleIndex_ / 8] |= (1 << (lastMatchedScheduleIndex_ % 8));
 
-        // Save to flash immediately to survive reboots
-        saveToFlash();
+        // Persist just the execution record to survive reboots
+        saveExecState();
 
-        Serial.printf("[SCHEDULE] Confirmed completed: %s on date %lu\n",
-                      schedules_[lastMatchedScheduleIndex_].time, today);
+        Serial.printf("[SCHEDULE] Confirmed completed: #%d on day %u\n",
+                      lastMatchedScheduleIndex_, executedDay_);
 
-        // Reset matched index
+        // Reset matched index; next check looks at the rest of this minute
         lastMatchedScheduleIndex_ = -1;
+        nextDueEpoch_ = 0;
+    }
+}
+
+void ScheduleManager::reanchor() {
+    anchored_ = false;
+    anchorMillis_ = millis() - SCHEDULE_INVALID_RTC_RETRY_MS;  // Anchors on the next check
+}
+
+// ============================================================================
+// EVENT INDEX
+// ============================================================================
+
+void ScheduleManager::rebuildIndex() {
+    // Sort schedule indices by minute of day (insertion sort - done once per ingest)
+    uint8_t order[MAX_SCHEDULES];
+    uint16_t minutes[MAX_SCHEDULES];
+    int n = 0;
+    for (int i = 0; i < scheduleCount_; i++) {
+        if (!schedules_[i].isEnabled()) continue;
+        uint16_t minute = schedules_[i].minuteOfDay;
+
+        int j = n;
+        while (j > 0 && minutes[j - 1] > minute) {
+            minutes[j] = minutes[j - 1];
+            order[j] = order[j - 1];
+            j--;
+        }
+        minutes[j] = minute;
+        order[j] = i;
+        n++;
+    }
+
+    // Expand per day - day-major over a minute-sorted list is already sorted by minute of week
+    eventCount_ = 0;
+    for (int day = 0; day < 7; day++) {
+        for (int k = 0; k < n; k++) {
+            if (schedules_[order[k]].daysOfWeek & (1 << day)) {
+                events_[eventCount_].minuteOfWeek = day * 1440 + minutes[k];
+                events_[eventCount_].schedule = order[k];
+                eventCount_++;
+            }
+        }
     }
+
+    // Index positions changed - re-anchor and rebuild the executed bitset on next check
+    nextEvent_ = 0;
+    executedDay_ = 0;
+    reanchor();
+    Serial.printf("[SCHEDULE] Event index: %d events from %d schedules\n", eventCount_, n);
+}
+
+void ScheduleManager::anchor(const DateTime& now) {
+    anchorMillis_ = millis();
+    if (now.year() < 2020) {
+        anchored_ = false;  // RTC not set yet - try again later
+        return;
+    }
+
+    refreshExecutedDay(now);
+    anchored_ = true;
+    if (eventCount_ == 0) {
+        return;
+    }
+
+    // Binary search: first event at or after the current minute of week
+    uint16_t mow = minuteOfWeek(now);
+    int lo = 0;
+    int hi = eventCount_;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (events_[mid].minuteOfWeek < mow) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    nextEvent_ = (lo < eventCount_) ? lo : 0;  // Past the last event - wrap to next week
+    armNextDue(now, false);
+}
+
+void ScheduleManager::armNextDue(const DateTime& now, bool skipCurrent) {
+    uint16_t mow = minuteOfWeek(now);
+    uint32_t deltaMin = (events_[nextEvent_].minuteOfWeek + MINUTES_PER_WEEK - mow) % MINUTES_PER_WEEK;
+    if (deltaMin == 0 && skipCurrent) {
+        deltaMin = MINUTES_PER_WEEK;  // Only event is this same minute - next week
+    }
+
+    // Due at second 0 of the event minute (immediately if that minute is now)
+    nextDueEpoch_ = now.unixtime() - now.second() + deltaMin * 60;
+}
+
+void ScheduleManager::refreshExecutedDay(const DateTime& now) {
+    uint16_t today = RTCManager::daySerial(now);
+    if (today == executedDay_) {
+        return;
+    }
+
+    executedDay_ = today;
+    memset(executedToday_, 0, sizeof(executedToday_));
+    for (int i = 0; i < scheduleCount_; i++) {
+        if (schedules_[i].lastExecutionDay == today) {
+            executedToday_[i / 8] |= (1 << (i % 8));
+        }
+    }
+}
+
+bool ScheduleManager::isExecutedToday(int schedule) const {
+    return executedToday_[schedule / 8] & (1 << (schedule % 8));
 }
 
 // ============================================================================
@@ -167,8 +334,79 @@ void ScheduleManager::confirmScheduleCompleted() {
 void ScheduleManager::loadFromFlash() {
     preferences_.begin("schedules", true);  // Read-only
 
-    scheduleCount_ = preferences_.getInt("count", 0);
+    uint8_t version = preferences_.getUChar("ver", 1);
+    scheduleCount_ = 0;
+    bool migrated = false;
 
+    if (version >= 3 && version <= SCHEDULE_LAYOUT_VERSION) {
+        bool converted = false;
+        if (!loadTable(converted)) {
+            Serial.println("[SCHEDULE] Stored table invalid (size/CRC) - starting empty");
+            scheduleCount_ = 0;
+        }
+        migrated = converted && scheduleCount_ > 0;
+    } else if (version < 3) {
+        loadLegacyKeys(version);
+        migrated = scheduleCount_ > 0;
+    }
+
+    preferences_.end();
+
+    if (migrated) {
+        Serial.printf("[SCHEDULE] Migrated %d schedules from layout v%u\n", scheduleCount_, version);
+        saveToFlash();
+    }
+    rebuildIndex();
+    recomputeTableHash();
+}
+
+bool ScheduleManager::loadTable(bool& converted) {
+    // One read for the whole table
+    uint8_t* blob = tableBlob;
+    size_t len = preferences_.getBytes("table", blob, sizeof(tableBlob));
+    if (len < sizeof(ScheduleTableHeader)) {
+        return len == 0;  // Never written = empty table
+    }
+
+    ScheduleTableHeader header;
+    memcpy(&header, blob, sizeof(header));
+    bool current = (header.version == SCHEDULE_LAYOUT_VERSION && header.entrySize == sizeof(Schedule));
+    bool v3 = (header.version == 3 && header.entrySize == sizeof(ScheduleV2));
+    size_t entriesLen = (size_t)header.count * header.entrySize;
+    if ((!current && !v3) || header.count > MAX_SCHEDULES || len != sizeof(header) + entriesLen) {
+        return false;
+    }
+
+    const uint8_t* entries = blob + sizeof(header);
+    if (crc32_le(0, entries, entriesLen) != header.crc) {
+        return false;
+    }
+    if (current) {
+        memcpy(schedules_, entries, entriesLen);
+    } else {
+        for (int i = 0; i < header.count; i++) {
+            ScheduleV2 legacy;
+            memcpy(&legacy, entries + i * sizeof(ScheduleV2), sizeof(legacy));
+            migrateV2(legacy, schedules_[i]);
+        }
+    }
+    scheduleCount_ = header.count;
+
+    // Overlay the execution record (written on its own after each feed)
+    ScheduleExecRecord exec;
+    if (preferences_.getBytes("exec", &exec, sizeof(exec)) == sizeof(exec) && exec.day != 0) {
+        for (int i = 0; i < scheduleCount_; i++) {
+            if (exec.bits[i / 8] & (1 << (i % 8))) {
+                schedules_[i].lastExecutionDay = exec.day;
+            }
+        }
+    }
+    converted = !current;
+    return true;
+}
+
+void ScheduleManager::loadLegacyKeys(uint8_t version) {
+    scheduleCount_ = preferences_.getInt("count", 0);
     if (scheduleCount_ > MAX_SCHEDULES) {
         scheduleCount_ = 0;
     }
@@ -177,32 +415,301 @@ void ScheduleManager::loadFromFlash() {
         char key[16];
         snprintf(key, sizeof(key), "sched_%d", i);
 
-        size_t len = preferences_.getBytes(key, &schedules_[i], sizeof(Schedule));
-        if (len != sizeof(Schedule)) {
+        bool ok;
+        if (version == 1) {
+            ScheduleV1 legacy;
+            ok = preferences_.getBytes(key, &legacy, sizeof(legacy)) == sizeof(legacy) &&
+                 migrateV1(legacy, schedules_[i]);
+        } else {
+            ScheduleV2 packed;
+            ok = preferences_.getBytes(key, &packed, sizeof(packed)) == sizeof(packed);
+            migrateV2(packed, schedules_[i]);
+        }
+        if (!ok) {
             // Corrupted data - reset
             scheduleCount_ = 0;
             break;
         }
     }
-
-    preferences_.end();
 }
 
 void ScheduleManager::saveToFlash() {
+    // Full table write - only when the schedule set changes
     preferences_.begin("schedules", false);  // Read-write
 
-    // Clear entire namespace to remove old entries (old format had 140+ keys)
-    preferences_.clear();
+    // Legacy layouts used up to 151 keys - drop them once when migrating
+    uint8_t storedVersion = preferences_.getUChar("ver", 1);
+    if (storedVersion < 3) {
+        preferences_.clear();
+    }
+    if (storedVersion != SCHEDULE_LAYOUT_VERSION) {
+        preferences_.putUChar("ver", SCHEDULE_LAYOUT_VERSION);
+    }
+
+    uint8_t* blob = tableBlob;
+    size_t entriesLen = (size_t)scheduleCount_ * sizeof(Schedule);
+    ScheduleTableHeader header;
+    header.version = SCHEDULE_LAYOUT_VERSION;
+    header.entrySize = sizeof(Schedule);
+    header.count = scheduleCount_;
+    header.crc = crc32_le(0, (const uint8_t*)schedules_, entriesLen);
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), schedules_, entriesLen);
+    preferences_.putBytes("table", blob, sizeof(header) + entriesLen);
+
+    writeExecRecord();
+    preferences_.end();
+}
+
+void ScheduleManager::saveExecState() {
+    // Delta write after a feed: one small record instead of the whole table
+    preferences_.begin("schedules", false);
+    writeExecRecord();
+    preferences_.end();
+}
+
+void ScheduleManager::writeExecRecord() {
+    // Bitset of schedules executed on executedDay_ (caller holds preferences_ open)
+    ScheduleExecRecord exec;
+    exec.day = executedDay_;
+    memcpy(exec.bits, executedToday_, sizeof(exec.bits));
+    preferences_.putBytes("exec", &exec, sizeof(exec));
+}
+
+void ScheduleManager::migrateV2(const ScheduleV2& packed, Schedule& schedule) {
+    schedule.id = 0;  // Unknown until the WiFi ESP re-syncs (digest will not match)
+    schedule.minuteOfDay = packed.minuteOfDay;
+    schedule.amountGrams = packed.amountGrams;
+    schedule.lastExecutionDay = packed.lastExecutionDay;
+    schedule.daysOfWeek = packed.daysOfWeek;
+    schedule.flags = packed.flags;
+}
+
+bool ScheduleManager::migrateV1(const ScheduleV1& legacy, Schedule& schedule) {
+    char time[6];
+    memcpy(time, legacy.time, sizeof(time));
+    time[5] = '\0';
+    int minuteOfDay = parseMinuteOfDay(time);
+    if (minuteOfDay < 0) {
+        return false;
+    }
+
+    schedule.id = 0;
+    schedule.minuteOfDay = minuteOfDay;
+    schedule.daysOfWeek = legacy.daysOfWeek;
+    schedule.amountGrams = (uint16_t)constrain(legacy.amount * 1000.0f + 0.5f, 0.0f, 65535.0f);
+    schedule.flags = legacy.enabled ? SCHEDULE_FLAG_ENABLED : 0;
+
+    // YYYYMMDD -> day serial
+    schedule.lastExecutionDay = 0;
+    if (legacy.lastExecutionDate != 0) {
+        DateTime date(legacy.lastExecutionDate / 10000, (legacy.lastExecutionDate / 100) % 100,
+                      legacy.lastExecutionDate % 100);
+        schedule.lastExecutionDay = RTCManager::daySerial(date);
+    }
+    return true;
+}
+
+// ============================================================================
+// INCREMENTAL SYNC (by id)
+// ============================================================================
+
+bool ScheduleManager::upsertSchedule(uint32_t id, uint16_t minuteOfDay, uint8_t daysOfWeek,
+                                     uint16_t amountGrams, bool enabled) {
+    if (id == 0 || minuteOfDay >= 1440 || daysOfWeek == 0 || daysOfWeek > 0x7F || amountGrams == 0) {
+        sendSyncReply(false, id, "invalid");
+        return false;
+    }
+
+    int index = findById(id);
+    if (index < 0) {
+        if (scheduleCount_ >= MAX_SCHEDULES) {
+            sendSyncReply(false, id, "full");
+            return false;
+        }
+        index = scheduleCount_++;
+        schedules_[index] = Schedule();
+        schedules_[index].id = id;
+    } else {
+        tableHash_ ^= entryHash(schedules_[index]);
+    }
+
+    // lastExecutionDay is kept on update so editing today's executed feed can't re-fire it
+    Schedule& schedule = schedules_[index];
+    schedule.minuteOfDay = minuteOfDay;
+    schedule.daysOfWeek = daysOfWeek;
+    schedule.amountGrams = amountGrams;
+    schedule.flags = enabled ? SCHEDULE_FLAG_ENABLED : 0;
+    tableHash_ ^= entryHash(schedule);
+
+    Serial.printf("[SCHEDULE] Upsert #%d id=%lu: %02u:%02u, days=0x%02X, amount=%u g, enabled=%d\n",
+                  index, id, minuteOfDay / 60, minuteOfDay % 60, daysOfWeek, amountGrams, enabled);
+
+    rebuildIndex();
+    sendSyncReply(true, id, nullptr);
+    saveToFlash();
+    return true;
+}
+
+bool ScheduleManager::deleteSchedule(uint32_t id) {
+    int index = findById(id);
+    if (index < 0) {
+        sendSyncReply(false, id, "unknown");
+        return false;
+    }
+
+    tableHash_ ^= entryHash(schedules_[index]);
+    memmove(&schedules_[index], &schedules_[index + 1],
+            (scheduleCount_ - index - 1) * sizeof(Schedule));
+    scheduleCount_--;
+
+    Serial.printf("[SCHEDULE] Deleted id=%lu (%d remaining)\n", id, scheduleCount_);
+
+    rebuildIndex();
+    sendSyncReply(true, id, nullptr);
+    saveToFlash();
+    return true;
+}
+
+void ScheduleManager::sendDigest() {
+    // Table hash first; WiFi ESP compares per-entry hashes only when it differs
+    char line[48];
+    snprintf(line, sizeof(line), "SCHEDULE_DIGEST:%d,%lu", scheduleCount_, tableHash_);
+    sendLine(line, LINK_PRIO_NORMAL);
+
+    // Entries follow from pumpReports() as the TX queue has room
+    digestCursor_ = 0;
+    digestTableHash_ = tableHash_;
+    pumpReports();
+}
+
+void ScheduleManager::pumpReports() {
+    char line[REPORT_LINE_MAX];
+
+    while (digestCursor_ >= 0) {
+        if (tableHash_ != digestTableHash_) {
+            // Table changed under the digest - start over so it stays consistent
+            sendDigest();
+            return;
+        }
+        if (link_ && !link_->canQueue(LINK_PRIO_NORMAL, REPORT_LINE_MAX + 8)) {
+            break;
+        }
+        if (digestCursor_ < scheduleCount_) {
+            const Schedule& sched = schedules_[digestCursor_++];
+            snprintf(line, sizeof(line), "SCHEDULE_ENTRY:%lu,%lu", sched.id, entryHash(sched));
+            sendLine(line, LINK_PRIO_NORMAL);
+        } else {
+            sendLine("SCHEDULE_DIGEST:END", LINK_PRIO_NORMAL);
+            digestCursor_ = -1;
+        }
+    }
+
+    while (statusCursor_ >= 0) {
+        if (link_ && !link_->canQueue(LINK_PRIO_BULK, REPORT_LINE_MAX + 8)) {
+            break;
+        }
+        if (statusCursor_ < scheduleCount_) {
+            int i = statusCursor_++;
+            const Schedule& sched = schedules_[i];
+
+            // Check if this schedule applies on the report's day
+            bool appliesToday = (sched.daysOfWeek & (1 << statusWeekday_));
+            bool executedToday = (sched.lastExecutionDay == statusDay_);
+
+            // Wire format unchanged: HH:MM, kg and YYYYMMDD
+            snprintf(line, sizeof(line),
+                     "SCHEDULE_ITEM:%d,Time=%02u:%02u,Days=0x%02X,Amount=%.3f,Enabled=%d,AppliesNow=%d,ExecutedToday=%d,LastExec=%lu",
+                     i, sched.minuteOfDay / 60, sched.minuteOfDay % 60, sched.daysOfWeek, sched.amountKg(),
+                     sched.isEnabled(), appliesToday, executedToday,
+                     RTCManager::daySerialToDate(sched.lastExecutionDay));
+            sendLine(line, LINK_PRIO_BULK);
+
+            Serial.printf("[SCHEDULE] Item %d: %02u:%02u, applies=%d, executed=%d\n",
+                          i, sched.minuteOfDay / 60, sched.minuteOfDay % 60, appliesToday, executedToday);
+        } else {
+            sendLine("SCHEDULE_STATUS:END", LINK_PRIO_BULK);
+            statusCursor_ = -1;
+        }
+    }
+}
 
-    preferences_.putInt("count", scheduleCount_);
+uint32_t ScheduleManager::getTableHash() const {
+    return tableHash_;
+}
 
+int ScheduleManager::findById(uint32_t id) const {
     for (int i = 0; i < scheduleCount_; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "sched_%d", i);
-        preferences_.putBytes(key, &schedules_[i], sizeof(Schedule));
+        if (schedules_[i].id == id) {
+            return i;
+        }
     }
+    return -1;
+}
 
-    preferences_.end();
+void ScheduleManager::rejectSync(uint32_t id, const char* reason) {
+    sendSyncReply(false, id, reason);
+}
+
+void ScheduleManager::sendSyncReply(bool ok, uint32_t id, const char* reason) {
+    bool binary = link_ && link_->isBinary();
+    char line[64];
+
+    if (ok) {
+        int index = findById(id);
+        uint32_t hash = index >= 0 ? entryHash(schedules_[index]) : 0;  // 0 = deleted
+        if (binary) {
+            LinkScheduleAckPayload payload;
+            payload.id = id;
+            payload.entryHash = hash;
+            payload.tableHash = tableHash_;
+            link_->sendFrame(MSG_SCHEDULE_ACK, &payload, sizeof(payload), LINK_PRIO_URGENT);
+        } else {
+            snprintf(line, sizeof(line), "SCHEDULE_ACK:%lu,%lu,%lu", id, hash, tableHash_);
+            sendLine(line, LINK_PRIO_URGENT);
+        }
+    } else {
+        if (binary) {
+            // u32 id followed by the reason text
+            uint8_t payload[sizeof(uint32_t) + 48];
+            size_t reasonLen = min(strlen(reason), sizeof(payload) - sizeof(uint32_t));
+            memcpy(payload, &id, sizeof(uint32_t));
+            memcpy(payload + sizeof(uint32_t), reason, reasonLen);
+            link_->sendFrame(MSG_SCHEDULE_NACK, payload, sizeof(uint32_t) + reasonLen, LINK_PRIO_URGENT);
+        } else {
+            snprintf(line, sizeof(line), "SCHEDULE_NACK:%lu,%s", id, reason);
+            sendLine(line, LINK_PRIO_URGENT);
+        }
+        Serial.printf("[SCHEDULE] Sync rejected for id=%lu: %s\n", id, reason);
+    }
+}
+
+uint32_t ScheduleManager::entryHash(const Schedule& schedule) {
+    // Synced fields only - execution state is local
+    uint8_t fields[10];
+    memcpy(fields, &schedule.id, 4);
+    memcpy(fields + 4, &schedule.minuteOfDay, 2);
+    memcpy(fields + 6, &schedule.amountGrams, 2);
+    fields[8] = schedule.daysOfWeek;
+    fields[9] = schedule.flags & SCHEDULE_FLAG_ENABLED;
+    return fnv1a(fields, sizeof(fields), FNV_OFFSET_BASIS);
+}
+
+void ScheduleManager::recomputeTableHash() {
+    // XOR of entry hashes: order-independent, and one entry changes it in O(1)
+    tableHash_ = 0;
+    for (int i = 0; i < scheduleCount_; i++) {
+        tableHash_ ^= entryHash(schedules_[i]);
+    }
+}
+
+uint32_t ScheduleManager::fnv1a(const void* data, size_t len, uint32_t hash) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
 }
 
 // ============================================================================
@@ -210,52 +717,49 @@ void ScheduleManager::saveToFlash() {
 // ============================================================================
 
 unsigned long ScheduleManager::calculateHash(const char* jsonString) {
-    unsigned long hash = 5381;
-    for (size_t i = 0; i < strlen(jsonString); i++) {
-        hash = ((hash << 5) + hash) + jsonString[i];
-    }
-    return hash;
+    SyncHash hash;
+    hash.update(jsonString, strlen(jsonString));
+    return hash.getValue();
 }
 
 void ScheduleManager::sendHashConfirmation(unsigned long hash) {
     char message[32];
     snprintf(message, sizeof(message), "SCHEDULE_HASH:%lu", hash);
-    Serial2.println(message);
+    if (link_ && link_->isBinary()) {
+        uint32_t value = hash;
+        link_->sendFrame(MSG_SCHEDULE_HASH, &value, sizeof(value), LINK_PRIO_URGENT);
+    } else {
+        sendLine(message, LINK_PRIO_URGENT);
+    }
     Serial.printf("[SCHEDULE] Hash sent: %s\n", message);
 }
 
 void ScheduleManager::sendScheduleStatus() {
     if (!rtcManager_) {
-        Serial2.println("SCHEDULE_STATUS:ERROR - No RTC");
+        sendLine("SCHEDULE_STATUS:ERROR - No RTC", LINK_PRIO_BULK);
         return;
     }
 
-    uint32_t today = rtcManager_->getCurrentDate();
-    int currentHour = rtcManager_->getHour();
-    int currentMinute = rtcManager_->getMinute();
-    int currentDay = rtcManager_->getDayOfWeek();
+    // One RTC read for the whole report
+    DateTime now = rtcManager_->now();
+    statusDay_ = RTCManager::daySerial(now);
+    statusWeekday_ = now.dayOfTheWeek();
 
     // Send current time and date
-    Serial2.printf("SCHEDULE_STATUS:Date=%lu,Time=%02d:%02d,Day=%d,Count=%d\n",
-                   today, currentHour, currentMinute, currentDay, scheduleCount_);
-
-    // Send status of each schedule
-    for (int i = 0; i < scheduleCount_; i++) {
-        const Schedule& sched = schedules_[i];
-
-        // Check if this schedule applies today
-        bool appliesToday = (sched.daysOfWeek & (1 << currentDay));
-        bool executedToday = (sched.lastExecutionDate == today);
-
-        Serial2.printf("SCHEDULE_ITEM:%d,Time=%s,Days=0x%02X,Amount=%.3f,Enabled=%d,AppliesNow=%d,ExecutedToday=%d,LastExec=%lu\n",
-                       i, sched.time, sched.daysOfWeek, sched.amount, sched.enabled,
-                       appliesToday, executedToday, sched.lastExecutionDate);
+    char line[REPORT_LINE_MAX];
+    snprintf(line, sizeof(line), "SCHEDULE_STATUS:Date=%lu,Time=%02d:%02d,Day=%d,Count=%d",
+             RTCManager::daySerialToDate(statusDay_), now.hour(), now.minute(), statusWeekday_, scheduleCount_);
+    sendLine(line, LINK_PRIO_BULK);
+
+    // Items follow from pumpReports() as the TX queue has room
+    statusCursor_ = 0;
+    pumpReports();
+}
 
-        Serial.printf("[SCHEDULE] Item %d: %s, applies=%d, executed=%d\n",
-                      i, sched.time, appliesToday, executedToday);
+void ScheduleManager::sendLine(const char* line, LinkPriority priority) {
+    if (link_) {
+        link_->sendLine(line, priority);
     }
-
-    Serial2.println("SCHEDULE_STATUS:END");
 }
 
 // ============================================================================
@@ -270,44 +774,16 @@ int ScheduleManager::getScheduleCount() const {
 // HELPERS
 // ============================================================================
 
-bool ScheduleManager::scheduleMatches(const Schedule& schedule) {
-    if (!schedule.enabled || !rtcManager_) {
-        return false;
-    }
-
-    // Parse schedule time
-    int schedHour, schedMinute;
-    if (sscanf(schedule.time, "%d:%d", &schedHour, &schedMinute) != 2) {
-        Serial.printf("[SCHEDULE] Failed to parse time: %s\n", schedule.time);
-        return false;
-    }
-
-    // Get current time components
-    int currentHour = rtcManager_->getHour();
-    int currentMinute = rtcManager_->getMinute();
-    int currentDay = rtcManager_->getDayOfWeek();
-    uint32_t currentDate = rtcManager_->getCurrentDate();
-
-    // Check time match first (most common failure)
-    if (currentHour != schedHour || currentMinute != schedMinute) {
-        return false;
-    }
-
-    // Check if today's day is in the bitmask
-    if (!(schedule.daysOfWeek & (1 << currentDay))) {
-        Serial.printf("[SCHEDULE] Day not in schedule: current=%d, bitmask=0x%02X\n",
-                      currentDay, schedule.daysOfWeek);
-        return false;
-    }
+uint16_t ScheduleManager::minuteOfWeek(const DateTime& now) {
+    return now.dayOfTheWeek() * 1440 + now.hour() * 60 + now.minute();
+}
 
-    // Check if already executed today
-    if (schedule.lastExecutionDate == currentDate) {
-        Serial.printf("[SCHEDULE] Already executed today: %s (date=%lu)\n",
-                      schedule.time, currentDate);
-        return false;
+int ScheduleManager::parseMinuteOfDay(const char* time) {
+    int hour, minute;
+    if (sscanf(time, "%d:%d", &hour, &minute) != 2 ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        Serial.printf("[SCHEDULE] Failed to parse time: %s\n", time);
+        return -1;
     }
-
-    Serial.printf("[SCHEDULE] MATCH FOUND! %s on day %d (date=%lu)\n",
-                  schedule.time, currentDay, currentDate);
-    return true;
+    return hour * 60 + minute;
 }
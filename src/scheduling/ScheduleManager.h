@@ -2,17 +2,30 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <RTClib.h>
 #include "../config/DataStructures.h"
 #include "../config/FeedingConfig.h"
+#include "ScheduleStreamParser.h"
+#include "../communication/SerialLink.h"
 
 // Forward declarations
 class RTCManager;
+struct ScheduleV1;
+struct ScheduleV2;
 
 // ============================================================================
 // SCHEDULE MANAGER
 // ============================================================================
 // Manages feeding schedules with NVS flash persistence
 // Parses JSON schedules from WiFi ESP and checks for matches
+// Full syncs are parsed byte by byte as they arrive into a staging table, so
+// memory is bounded by MAX_SCHEDULES rather than by the document size
+// Incremental sync: entries carry a stable id; UPSERT/DELETE change one entry,
+// and per-entry FNV-1a hashes XOR into a table hash the WiFi ESP can reconcile against
+// Schedules are compiled at ingest into a sorted minute-of-week event index;
+// the manager tracks only the unix second the next event is due and compares
+// it with RTCManager's cached epoch, so checkSchedules() is O(1), runs every
+// loop and fires on the RTC's own minute boundary
 
 class ScheduleManager {
 public:
@@ -21,41 +34,144 @@ public:
     // Initialize with RTC dependency
     void begin(RTCManager* rtcManager);
 
+    // Route replies through the Serial2 link (hash/ACK/NACK frames in binary mode)
+    void setLink(SerialLink* link);
+
     // Parse and cache schedules from JSON string
     bool parseSchedules(const char* jsonString);
 
-    // Check if any schedule matches current time
+    // Streaming full sync: begin, feed each byte of the document, then end at the
+    // line terminator (commits the staging table; false = malformed, table kept)
+    void beginStreamSync();
+    void streamSyncByte(char c);
+    bool endStreamSync();
+    void abortStreamSync();
+
+    // Check if the next due schedule has fired (cheap - call every loop while not feeding)
     bool checkSchedules(float& amount);
 
+    // Re-align the next-due anchor with the RTC (call after a time sync)
+    void reanchor();
+
     // Mark current schedule as completed (call ONLY after feeding starts successfully)
     void confirmScheduleCompleted();
 
     // Get cached schedule count
     int getScheduleCount() const;
 
-    // Load/save schedules from/to flash
+    // Load/save schedules from/to flash (single versioned, CRC-checked blob)
     void loadFromFlash();
     void saveToFlash();
 
-    // Calculate hash for schedule verification
+    // Incremental sync by id (replies SCHEDULE_ACK / SCHEDULE_NACK on Serial2)
+    bool upsertSchedule(uint32_t id, uint16_t minuteOfDay, uint8_t daysOfWeek,
+                        uint16_t amountGrams, bool enabled);
+    bool deleteSchedule(uint32_t id);
+
+    // NACK an incremental sync message that could not be decoded
+    void rejectSync(uint32_t id, const char* reason);
+
+    // Send table hash plus per-entry (id, hash) pairs for reconciliation
+    // (header now, entries paced by pumpReports())
+    void sendDigest();
+    uint32_t getTableHash() const;
+
+    // Confirmation digest of a whole document (streamed syncs hash as they receive)
     unsigned long calculateHash(const char* jsonString);
 
     // Send hash confirmation via Serial2
     void sendHashConfirmation(unsigned long hash);
 
-    // Send schedule status for remote debugging
+    // Send schedule status for remote debugging (header now, items paced by pumpReports())
     void sendScheduleStatus();
 
+    // Queue the next digest / status lines while the TX queue has room (call every loop)
+    void pumpReports();
+
 private:
     RTCManager* rtcManager_;
+    SerialLink* link_;
     Preferences preferences_;
 
     Schedule schedules_[MAX_SCHEDULES];
     int scheduleCount_;
 
+    // Full sync in progress (swapped in only once the whole document parsed)
+    ScheduleStreamParser parser_;
+    Schedule staging_[MAX_SCHEDULES];
+    unsigned long streamStartTime_;
+
     // Track which schedule matched (for confirming completion)
     int lastMatchedScheduleIndex_;
 
-    // Helper to check if schedule matches current time
-    bool scheduleMatches(const Schedule& schedule);
+    // Sorted minute-of-week event index (one entry per enabled schedule per day)
+    struct ScheduleEvent {
+        uint16_t minuteOfWeek;   // dayOfWeek * 1440 + minute of day (0=Sunday 00:00)
+        uint8_t schedule;        // Index into schedules_
+    };
+    static const uint16_t MINUTES_PER_WEEK = 7 * 1440;
+    ScheduleEvent events_[MAX_SCHEDULES * 7];
+    int eventCount_;
+    int nextEvent_;              // Index of the next due event
+
+    // Next-due tracking
+    bool anchored_;              // False until a valid RTC read (or after schedule/time change)
+    unsigned long anchorMillis_; // millis() of the last anchoring attempt (invalid-RTC retry)
+    uint32_t nextDueEpoch_;      // Unix second the next event is due
+
+    // Executed-today bitset (rebuilt from lastExecutionDay when the date changes)
+    uint16_t executedDay_;       // Day serial the bitset refers to
+    uint8_t executedToday_[(MAX_SCHEDULES + 7) / 8];
+
+    // Rebuild events_ from schedules_ (at ingest/load, never on the check path)
+    void rebuildIndex();
+
+    // Read position from one RTC DateTime and find the next event (binary search)
+    void anchor(const DateTime& now);
+
+    // Arm nextDueEpoch_ for events_[nextEvent_]; skipCurrent = minute already handled
+    void armNextDue(const DateTime& now, bool skipCurrent);
+
+    // Keep the executed bitset on the RTC's date
+    void refreshExecutedDay(const DateTime& now);
+    bool isExecutedToday(int schedule) const;
+
+    static uint16_t minuteOfWeek(const DateTime& now);
+    static int parseMinuteOfDay(const char* time);  // "HH:MM" -> minutes, -1 on error
+
+    // Per-day execution record, persisted separately from the table
+    struct ScheduleExecRecord {
+        uint16_t day;            // Day serial the bits refer to (0 = none)
+        uint8_t bits[(MAX_SCHEDULES + 7) / 8];
+    };
+
+    // XOR of entryHash() over all schedules (kept up to date incrementally)
+    uint32_t tableHash_;
+
+    int findById(uint32_t id) const;
+    void sendSyncReply(bool ok, uint32_t id, const char* reason);
+
+    // Paced reports (-1 = idle)
+    static const size_t REPORT_LINE_MAX = 160;
+    int digestCursor_;
+    uint32_t digestTableHash_;   // Table the digest header described
+    int statusCursor_;
+    uint16_t statusDay_;         // Day serial / weekday the status header reported
+    int statusWeekday_;
+
+    // One protocol line to the WiFi ESP (via link_)
+    void sendLine(const char* line, LinkPriority priority);
+    void recomputeTableHash();
+    static uint32_t entryHash(const Schedule& schedule);
+    static uint32_t fnv1a(const void* data, size_t len, uint32_t hash);
+
+    // Flash helpers (preferences_ must be open)
+    bool loadTable(bool& converted);        // Versioned, CRC-checked "table" blob + "exec" overlay
+    void loadLegacyKeys(uint8_t version);   // Layouts 1-2: one key per schedule
+    void writeExecRecord();
+    void saveExecState();                   // Small write after a feed is confirmed
+
+    // Convert legacy flash records (layout v1 / packed v2-v3 without id)
+    static void migrateV2(const ScheduleV2& packed, Schedule& schedule);
+    static bool migrateV1(const ScheduleV1& legacy, Schedule& schedule);
 };
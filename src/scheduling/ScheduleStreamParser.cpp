@@ -0,0 +1,353 @@
+#include "ScheduleStreamParser.h"
+
+// FNV-1a 32-bit (entry id from the raw key text - matches ScheduleManager)
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+ScheduleStreamParser::ScheduleStreamParser()
+    : state_(S_ROOT_OPEN),
+      afterToken_(S_ROOT_OPEN),
+      target_(T_IGNORE),
+      escape_(false),
+      skipInString_(false),
+      skipDepth_(0),
+      tokenLen_(0),
+      field_(T_IGNORE),
+      entryId_(0),
+      entryMinute_(-1),
+      entryDays_(0),
+      entryDayCount_(0),
+      entryAmount_(0),
+      entryEnabled_(true),
+      staging_(nullptr),
+      capacity_(0),
+      count_(0),
+      truncated_(false) {
+    token_[0] = '\0';
+    firstChars_[0] = firstChars_[1] = '\0';
+}
+
+// ============================================================================
+// DOCUMENT CONTROL
+// ============================================================================
+
+void ScheduleStreamParser::begin(Schedule* staging, int capacity) {
+    staging_ = staging;
+    capacity_ = capacity;
+    count_ = 0;
+    truncated_ = false;
+
+    state_ = S_ROOT_OPEN;
+    escape_ = false;
+    tokenLen_ = 0;
+
+    hash_.reset();
+}
+
+void ScheduleStreamParser::feed(char c) {
+    if (hash_.getLength() < 2) {
+        firstChars_[hash_.getLength()] = c;
+    }
+    hash_.update(c);
+
+    // Structural states re-dispatch the byte that ended a scalar
+    while (!consume(c)) {
+    }
+}
+
+ScheduleStreamParser::Status ScheduleStreamParser::finish() const {
+    if (state_ == S_TRAILING || isEmptyDocument()) {
+        return STREAM_COMPLETE;
+    }
+    return STREAM_ERROR;  // Malformed, or the line ended mid-document
+}
+
+// ============================================================================
+// TOKENIZER
+// ============================================================================
+
+bool ScheduleStreamParser::consume(char c) {
+    switch (state_) {
+        case S_STRING:
+            if (escape_) {
+                escape_ = false;  // Simple escapes keep the escaped byte (\uXXXX is not decoded)
+            } else if (c == '\\') {
+                escape_ = true;
+                return true;
+            } else if (c == '"') {
+                endToken();
+                state_ = afterToken_;
+                return true;
+            }
+            if (target_ == T_ROOT_KEY) {
+                entryId_ = (entryId_ ^ (uint8_t)c) * FNV_PRIME;
+            } else if (target_ != T_IGNORE && tokenLen_ < TOKEN_MAX) {
+                token_[tokenLen_++] = c;
+            }
+            return true;
+
+        case S_SCALAR:
+            if (isSpace(c) || c == ',' || c == '}' || c == ']') {
+                endToken();
+                state_ = afterToken_;
+                return false;  // Delimiter belongs to the enclosing state
+            }
+            if (tokenLen_ < TOKEN_MAX) {
+                token_[tokenLen_++] = c;
+            }
+            return true;
+
+        case S_SKIP:
+            if (skipInString_) {
+                if (escape_) escape_ = false;
+                else if (c == '\\') escape_ = true;
+                else if (c == '"') skipInString_ = false;
+            } else if (c == '"') {
+                skipInString_ = true;
+            } else if (c == '{' || c == '[') {
+                skipDepth_++;
+            } else if (c == '}' || c == ']') {
+                if (--skipDepth_ == 0) {
+                    state_ = afterToken_;
+                }
+            }
+            return true;
+
+        case S_TRAILING:
+            return true;
+
+        case S_ERROR:
+            return true;
+
+        default:
+            break;
+    }
+
+    // Structural states: whitespace is insignificant
+    if (isSpace(c)) {
+        return true;
+    }
+
+    switch (state_) {
+        case S_ROOT_OPEN:
+            state_ = (c == '{') ? S_ROOT_KEY : S_ERROR;
+            break;
+
+        case S_ROOT_KEY:
+            if (c == '"') {
+                entryId_ = FNV_OFFSET_BASIS;
+                target_ = T_ROOT_KEY;
+                tokenLen_ = 0;
+                afterToken_ = S_ROOT_COLON;
+                state_ = S_STRING;
+            } else {
+                state_ = (c == '}') ? S_TRAILING : S_ERROR;
+            }
+            break;
+
+        case S_ROOT_COLON:
+            state_ = (c == ':') ? S_ROOT_VALUE : S_ERROR;
+            break;
+
+        case S_ROOT_VALUE:
+            if (c == '{') {
+                startEntry();
+                state_ = S_ENTRY_KEY;
+            } else {
+                beginValue(c, T_IGNORE, S_ROOT_NEXT);  // Not an object - ignored
+            }
+            break;
+
+        case S_ROOT_NEXT:
+            if (c == ',') state_ = S_ROOT_KEY;
+            else state_ = (c == '}') ? S_TRAILING : S_ERROR;
+            break;
+
+        case S_ENTRY_KEY:
+            if (c == '"') {
+                target_ = T_FIELD_NAME;
+                tokenLen_ = 0;
+                afterToken_ = S_ENTRY_COLON;
+                state_ = S_STRING;
+            } else if (c == '}') {
+                finishEntry();
+                state_ = S_ROOT_NEXT;
+            } else {
+                state_ = S_ERROR;
+            }
+            break;
+
+        case S_ENTRY_COLON:
+            state_ = (c == ':') ? S_ENTRY_VALUE : S_ERROR;
+            break;
+
+        case S_ENTRY_VALUE:
+            if (field_ == T_DAY && c == '[') {
+                state_ = S_DAYS_ITEM;
+            } else {
+                beginValue(c, field_ == T_DAY ? T_IGNORE : field_, S_ENTRY_NEXT);
+            }
+            break;
+
+        case S_ENTRY_NEXT:
+            if (c == ',') {
+                state_ = S_ENTRY_KEY;
+            } else if (c == '}') {
+                finishEntry();
+                state_ = S_ROOT_NEXT;
+            } else {
+                state_ = S_ERROR;
+            }
+            break;
+
+        case S_DAYS_ITEM:
+            if (c == ']') {
+                state_ = S_ENTRY_NEXT;
+            } else {
+                entryDayCount_++;
+                beginValue(c, T_DAY, S_DAYS_NEXT);
+            }
+            break;
+
+        case S_DAYS_NEXT:
+            if (c == ',') state_ = S_DAYS_ITEM;
+            else state_ = (c == ']') ? S_ENTRY_NEXT : S_ERROR;
+            break;
+
+        default:
+            state_ = S_ERROR;
+            break;
+    }
+    return true;
+}
+
+void ScheduleStreamParser::beginValue(char c, Target target, State after) {
+    target_ = target;
+    tokenLen_ = 0;
+    afterToken_ = after;
+
+    if (c == '"') {
+        state_ = S_STRING;
+    } else if (c == '{' || c == '[') {
+        skipDepth_ = 1;
+        skipInString_ = false;
+        state_ = S_SKIP;
+    } else if (c == '}' || c == ']' || c == ',' || c == ':') {
+        state_ = S_ERROR;  // Missing value
+    } else {
+        token_[tokenLen_++] = c;
+        state_ = S_SCALAR;
+    }
+}
+
+void ScheduleStreamParser::endToken() {
+    token_[tokenLen_] = '\0';
+
+    switch (target_) {
+        case T_FIELD_NAME:
+            field_ = fieldFor(token_);
+            break;
+
+        case T_TIME: {
+            int hour, minute;
+            if (sscanf(token_, "%d:%d", &hour, &minute) == 2 &&
+                hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59) {
+                entryMinute_ = hour * 60 + minute;
+            }
+            break;
+        }
+
+        case T_DAY: {
+            int day = atoi(token_);
+            if (day >= 0 && day <= 6) {
+                entryDays_ |= (1 << day);
+            }
+            break;
+        }
+
+        case T_AMOUNT:
+            entryAmount_ = atof(token_);
+            break;
+
+        case T_ENABLED:
+            entryEnabled_ = (strcmp(token_, "false") != 0);
+            break;
+
+        default:
+            break;
+    }
+    target_ = T_IGNORE;
+}
+
+// ============================================================================
+// ENTRY ASSEMBLY
+// ============================================================================
+
+void ScheduleStreamParser::startEntry() {
+    entryMinute_ = -1;
+    entryDays_ = 0;
+    entryDayCount_ = 0;
+    entryAmount_ = 0;
+    entryEnabled_ = true;  // Default true
+    field_ = T_IGNORE;
+}
+
+void ScheduleStreamParser::finishEntry() {
+    // Same acceptance rule as before: valid time, non-empty days, positive amount
+    if (entryMinute_ < 0 || entryDayCount_ == 0 || entryAmount_ <= 0) {
+        return;
+    }
+    if (count_ >= capacity_) {
+        if (!truncated_) {
+            Serial.println("[SCHEDULE] Max schedules reached - skipping remaining");
+        }
+        truncated_ = true;
+        return;
+    }
+
+    Schedule& schedule = staging_[count_++];
+    schedule = Schedule();
+    schedule.id = entryId_;
+    schedule.minuteOfDay = entryMinute_;
+    schedule.daysOfWeek = entryDays_;
+    schedule.amountGrams = (uint16_t)min(entryAmount_ + 0.5f, 65535.0f);
+    schedule.flags = entryEnabled_ ? SCHEDULE_FLAG_ENABLED : 0;
+}
+
+// ============================================================================
+// GETTERS / HELPERS
+// ============================================================================
+
+int ScheduleStreamParser::getCount() const {
+    return count_;
+}
+
+bool ScheduleStreamParser::isEmptyDocument() const {
+    // Exact "{}" after trimming, as the old strcmp() check
+    size_t len = hash_.getTrimmedLength();
+    return len == 0 || (len == 2 && firstChars_[0] == '{' && firstChars_[1] == '}');
+}
+
+bool ScheduleStreamParser::wasTruncated() const {
+    return truncated_;
+}
+
+uint32_t ScheduleStreamParser::getHash() const {
+    return hash_.getValue();
+}
+
+bool ScheduleStreamParser::isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+ScheduleStreamParser::Target ScheduleStreamParser::fieldFor(const char* name) {
+    if (strcmp(name, "time") == 0) return T_TIME;
+    if (strcmp(name, "days") == 0) return T_DAY;
+    if (strcmp(name, "amount") == 0) return T_AMOUNT;
+    if (strcmp(name, "enabled") == 0) return T_ENABLED;
+    return T_IGNORE;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/DataStructures.h"
+#include "SyncHash.h"
+
+// ============================================================================
+// SCHEDULE STREAM PARSER
+// ============================================================================
+// Byte-at-a-time tokenizer for the SCHEDULES: document, fed straight from
+// Serial2 so nothing is buffered beyond one entry:
+//   { "<key>": { "time": "HH:MM", "days": [0,1,...], "amount": <g>, "enabled": <bool> }, ... }
+// Complete, valid entries are written to a caller-owned staging table; unknown
+// fields and non-object values are skipped at any nesting depth.
+// Also keeps the confirmation digest of the document text (see SyncHash).
+
+class ScheduleStreamParser {
+public:
+    enum Status {
+        STREAM_IN_PROGRESS,  // Document not finished yet
+        STREAM_COMPLETE,     // Root object closed (or nothing received)
+        STREAM_ERROR         // Malformed document - staging table must be discarded
+    };
+
+    ScheduleStreamParser();
+
+    // Start a new document, writing entries to staging[0..capacity)
+    void begin(Schedule* staging, int capacity);
+
+    // Consume one byte of the document
+    void feed(char c);
+
+    // Result once the line terminator arrived
+    Status finish() const;
+
+    int getCount() const;           // Valid entries written to staging
+    bool isEmptyDocument() const;   // Nothing, or exactly "{}" (confirmed with hash 0)
+    bool wasTruncated() const;      // More valid entries than capacity
+    uint32_t getHash() const;       // Confirmation digest of the document text
+
+private:
+    enum State {
+        S_ROOT_OPEN,       // Expect '{'
+        S_ROOT_KEY,        // Expect '"' (entry key) or '}'
+        S_ROOT_COLON,
+        S_ROOT_VALUE,      // Expect '{' (entry) - anything else is skipped
+        S_ROOT_NEXT,       // Expect ',' or '}'
+        S_ENTRY_KEY,       // Expect '"' (field name) or '}'
+        S_ENTRY_COLON,
+        S_ENTRY_VALUE,
+        S_ENTRY_NEXT,      // Expect ',' or '}'
+        S_DAYS_ITEM,       // Inside "days": expect value or ']'
+        S_DAYS_NEXT,       // Expect ',' or ']'
+        S_STRING,          // Inside a string, then resume afterToken_
+        S_SCALAR,          // Number/literal, then re-dispatch delimiter in afterToken_
+        S_SKIP,            // Skipping a nested object/array, then afterToken_
+        S_TRAILING,        // Root closed - ignore the rest (as deserializeJson did)
+        S_ERROR
+    };
+
+    // What the string/scalar being read is for
+    enum Target {
+        T_IGNORE,
+        T_ROOT_KEY,        // Hashed into the entry id
+        T_FIELD_NAME,
+        T_TIME,
+        T_DAY,
+        T_AMOUNT,
+        T_ENABLED
+    };
+
+    static const uint8_t TOKEN_MAX = 15;
+
+    State state_;
+    State afterToken_;
+    Target target_;
+    bool escape_;
+    bool skipInString_;
+    uint8_t skipDepth_;
+
+    char token_[TOKEN_MAX + 1];     // Current field name / scalar / time string
+    uint8_t tokenLen_;
+    Target field_;                  // Field whose value comes next
+
+    // Entry being assembled
+    uint32_t entryId_;
+    int entryMinute_;
+    uint8_t entryDays_;
+    uint8_t entryDayCount_;
+    float entryAmount_;
+    bool entryEnabled_;
+
+    // Output
+    Schedule* staging_;
+    int capacity_;
+    int count_;
+    bool truncated_;
+
+    // Confirmation digest, plus the first bytes to recognise "{}"
+    SyncHash hash_;
+    char firstChars_[2];
+
+    // Returns false if c must be re-dispatched in the new state
+    bool consume(char c);
+
+    void beginValue(char c, Target target, State after);
+    void endToken();
+    void startEntry();
+    void finishEntry();
+
+    static bool isSpace(char c);
+    static Target fieldFor(const char* name);
+};
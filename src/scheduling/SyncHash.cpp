@@ -0,0 +1,89 @@
+#include "SyncHash.h"
+#if SCHEDULE_HASH_CRC32
+#include <rom/crc.h>
+#endif
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+SyncHash::SyncHash()
+    : value_(initial()),
+      pending_(initial()),
+      length_(0),
+      trimmedLength_(0) {
+}
+
+void SyncHash::reset() {
+    value_ = initial();
+    pending_ = initial();
+    length_ = 0;
+    trimmedLength_ = 0;
+}
+
+// ============================================================================
+// UPDATE
+// ============================================================================
+
+void SyncHash::update(char c) {
+    update(&c, 1);
+}
+
+void SyncHash::update(const char* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    // Last non-blank byte in this chunk (len = none)
+    size_t last = len;
+    for (size_t i = len; i > 0; i--) {
+        if (bytes[i - 1] != ' ' && bytes[i - 1] != '\t') {
+            last = i - 1;
+            break;
+        }
+    }
+
+    if (last == len) {
+        // All blank - held back until something follows
+        pending_ = step(pending_, bytes, len);
+    } else {
+        value_ = step(pending_, bytes, last + 1);
+        pending_ = step(value_, bytes + last + 1, len - last - 1);
+        trimmedLength_ = length_ + last + 1;
+    }
+    length_ += len;
+}
+
+// ============================================================================
+// GETTERS / HELPERS
+// ============================================================================
+
+uint32_t SyncHash::getValue() const {
+    return value_;
+}
+
+size_t SyncHash::getLength() const {
+    return length_;
+}
+
+size_t SyncHash::getTrimmedLength() const {
+    return trimmedLength_;
+}
+
+uint32_t SyncHash::initial() {
+#if SCHEDULE_HASH_CRC32
+    return 0;
+#else
+    return 5381;
+#endif
+}
+
+uint32_t SyncHash::step(uint32_t hash, const uint8_t* data, size_t len) {
+#if SCHEDULE_HASH_CRC32
+    // ROM table-driven CRC-32 (IEEE, same as zlib crc32); chains across calls
+    return len ? crc32_le(hash, data, len) : hash;
+#else
+    for (size_t i = 0; i < len; i++) {
+        hash = ((hash << 5) + hash) + data[i];
+    }
+    return hash;
+#endif
+}
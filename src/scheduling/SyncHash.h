@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/FeedingConfig.h"
+
+// ============================================================================
+// SYNC HASH (SCHEDULE_HASH confirmation digest)
+// ============================================================================
+// Incremental digest of a schedule document, updated as bytes arrive so the
+// confirmation is ready the moment the line terminator is read
+// Trailing spaces/tabs are excluded (the line receiver always trimmed them):
+// a blank run is only folded into the digest once a non-blank byte follows
+// Algorithm: djb2, or ROM CRC-32 with SCHEDULE_HASH_CRC32 (WiFi ESP must match)
+
+class SyncHash {
+public:
+    SyncHash();
+
+    // Start a new document
+    void reset();
+
+    // Add bytes of the document
+    void update(char c);
+    void update(const char* data, size_t len);
+
+    // Digest of the document up to its last non-blank byte
+    uint32_t getValue() const;
+
+    size_t getLength() const;          // Bytes received
+    size_t getTrimmedLength() const;   // Bytes up to the last non-blank byte
+
+private:
+    uint32_t value_;                   // Digest of the trimmed text
+    uint32_t pending_;                 // Digest including the trailing blank run
+    size_t length_;
+    size_t trimmedLength_;
+
+    static uint32_t initial();
+    static uint32_t step(uint32_t hash, const uint8_t* data, size_t len);
+};
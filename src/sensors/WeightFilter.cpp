@@ -0,0 +1,148 @@
+#include "WeightFilter.h"
+#include "../config/CalibrationConfig.h"
+
+// Scale factor that turns MAD into a standard deviation estimate for Gaussian noise
+#define HAMPEL_MAD_TO_SIGMA 1.4826f
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+WeightFilter::WeightFilter()
+    : mode_(WEIGHT_FILTER_NONE),
+      emaAlpha_(SCALE_EMA_ALPHA),
+      processVariance_(1.0f),
+      measurementVariance_(1.0f),
+      minSpread_(0.0f),
+      windowSize_(min<uint8_t>(SCALE_HAMPEL_WINDOW, MAX_WINDOW)),
+      windowHead_(0),
+      windowCount_(0),
+      estimate_(0.0f),
+      errorVariance_(0.0f),
+      hasValue_(false),
+      rejectedCount_(0) {
+}
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+void WeightFilter::configure(WeightFilterMode mode, float emaAlpha,
+                             float processNoise, float measurementNoise, float minSpread) {
+    mode_ = mode;
+    emaAlpha_ = constrain(emaAlpha, 0.01f, 1.0f);
+    processVariance_ = processNoise * processNoise;
+    measurementVariance_ = measurementNoise * measurementNoise;
+    minSpread_ = fabs(minSpread);
+}
+
+void WeightFilter::reset() {
+    windowHead_ = 0;
+    windowCount_ = 0;
+    estimate_ = 0.0f;
+    errorVariance_ = 0.0f;
+    hasValue_ = false;
+}
+
+// ============================================================================
+// PER-SAMPLE PROCESSING
+// ============================================================================
+
+float WeightFilter::process(float sample) {
+    float clean = hampel(sample);
+    estimate_ = smooth(clean);
+    hasValue_ = true;
+    return clean;
+}
+
+float WeightFilter::hampel(float sample) {
+    window_[windowHead_] = sample;
+    windowHead_ = (windowHead_ + 1) % windowSize_;
+    if (windowCount_ < windowSize_) {
+        windowCount_++;
+    }
+
+    // Not enough history to judge yet - pass through
+    if (windowCount_ < windowSize_) {
+        return sample;
+    }
+
+    float sorted[MAX_WINDOW];
+    memcpy(sorted, window_, windowSize_ * sizeof(float));
+    float med = median(sorted, windowSize_);
+
+    // Median absolute deviation
+    for (uint8_t i = 0; i < windowSize_; i++) {
+        sorted[i] = fabs(window_[i] - med);
+    }
+    float sigma = HAMPEL_MAD_TO_SIGMA * median(sorted, windowSize_);
+    if (sigma < minSpread_) {
+        sigma = minSpread_;
+    }
+
+    if (fabs(sample - med) > SCALE_HAMPEL_THRESHOLD * sigma) {
+        rejectedCount_++;
+        return med;
+    }
+    return sample;
+}
+
+float WeightFilter::smooth(float sample) {
+    if (!hasValue_) {
+        // First sample seeds the estimate
+        errorVariance_ = measurementVariance_;
+        return sample;
+    }
+
+    switch (mode_) {
+        case WEIGHT_FILTER_EMA:
+            return estimate_ + emaAlpha_ * (sample - estimate_);
+
+        case WEIGHT_FILTER_KALMAN: {
+            // Predict: weight assumed constant, uncertainty grows by Q
+            errorVariance_ += processVariance_;
+            // Update
+            float gain = errorVariance_ / (errorVariance_ + measurementVariance_);
+            errorVariance_ *= (1.0f - gain);
+            return estimate_ + gain * (sample - estimate_);
+        }
+
+        case WEIGHT_FILTER_NONE:
+        default:
+            return sample;
+    }
+}
+
+float WeightFilter::median(float* values, uint8_t n) {
+    // Insertion sort - fastest option for n <= 9
+    for (uint8_t i = 1; i < n; i++) {
+        float v = values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+    return values[n / 2];
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+float WeightFilter::getValue() const {
+    return estimate_;
+}
+
+bool WeightFilter::hasValue() const {
+    return hasValue_;
+}
+
+WeightFilterMode WeightFilter::getMode() const {
+    return mode_;
+}
+
+uint32_t WeightFilter::getRejectedCount() const {
+    return rejectedCount_;
+}
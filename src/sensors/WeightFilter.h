@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// WEIGHT FILTER (streaming load-cell filter chain)
+// ============================================================================
+// Per-sample pipeline, O(1) per sample:
+//   1. Hampel spike rejector - replaces a sample with the window median when it
+//      deviates more than threshold * MAD (motor vibration, relay spikes)
+//   2. Smoothing stage - EMA or 1-D Kalman (constant-weight model)
+// Works in raw HX711 counts so tare offset changes never disturb filter state
+
+enum WeightFilterMode {
+    WEIGHT_FILTER_NONE,     // Spike rejection only
+    WEIGHT_FILTER_EMA,      // Exponential moving average
+    WEIGHT_FILTER_KALMAN    // 1-D Kalman filter
+};
+
+class WeightFilter {
+public:
+    WeightFilter();
+
+    // Configure smoothing stage and Hampel MAD floor (noise values in raw counts)
+    void configure(WeightFilterMode mode, float emaAlpha,
+                   float processNoise, float measurementNoise, float minSpread);
+
+    // Clear all filter state
+    void reset();
+
+    // Feed one raw sample; returns the spike-rejected sample
+    float process(float sample);
+
+    // Current smoothed estimate (raw counts)
+    float getValue() const;
+
+    // True once at least one sample has been processed
+    bool hasValue() const;
+
+    WeightFilterMode getMode() const;
+
+    // Number of samples replaced by the Hampel stage (diagnostics)
+    uint32_t getRejectedCount() const;
+
+private:
+    static const uint8_t MAX_WINDOW = 9;
+
+    WeightFilterMode mode_;
+    float emaAlpha_;
+    float processVariance_;      // Kalman Q
+    float measurementVariance_;  // Kalman R
+    float minSpread_;            // Hampel MAD floor
+
+    // Hampel window (raw input samples)
+    float window_[MAX_WINDOW];
+    uint8_t windowSize_;
+    uint8_t windowHead_;
+    uint8_t windowCount_;
+
+    // Smoothing stage state
+    float estimate_;
+    float errorVariance_;        // Kalman P
+    bool hasValue_;
+
+    uint32_t rejectedCount_;
+
+    float hampel(float sample);
+    float smooth(float sample);
+
+    // Median of n values (sorts the buffer in place - n is tiny)
+    static float median(float* values, uint8_t n);
+};
@@ -10,7 +10,14 @@
 WeightSensor::WeightSensor()
     : calibrationFactor_(SCALE_CALIBRATION_FACTOR),
       initialized_(false),
-      lastValidWeight_(0.0f) {
+      lastValidWeight_(0.0f),
+      filterMode_(SCALE_FILTER_MODE),
+      sampleHead_(0),
+      sampleCount_(0),
+      lastSampleTime_(0),
+      totalSamples_(0),
+      readWindowSum_(0),
+      fastWindowSum_(0) {
 }
 
 // ============================================================================
@@ -25,6 +32,7 @@ bool WeightSensor::begin(uint8_t doutPin, uint8_t clkPin, float calibrationFacto
 
     // Set calibration factor immediately after begin()
     scale_.set_scale(calibrationFactor_);
+    configureFilter();
 
     // Wait up to 500ms for HX711 to signal ready (DOUT low = ready)
     unsigned long start = millis();
@@ -37,38 +45,70 @@ bool WeightSensor::begin(uint8_t doutPin, uint8_t clkPin, float calibrationFacto
     }
 
     initialized_ = true;
+
+    // Prime the buffer so the first read after boot has data
+    pushSample(scale_.read());
     return true;
 }
 
 // ============================================================================
-// WEIGHT READING
+// NON-BLOCKING ACQUISITION
 // ============================================================================
 
-float WeightSensor::readWeight() {
-    if (!initialized_) return SENSOR_ERROR_VALUE;
+void WeightSensor::update() {
+    if (!initialized_) return;
 
-    // Read average of multiple samples
-    // Multiply by 4 (hardware-specific calibration for load cell configuration)
-    float rawReading = scale_.get_units(SCALE_READ_SAMPLES);
+    // DOUT low = conversion ready; read() returns immediately (~60us of clocking)
+    if (scale_.is_ready()) {
+        pushSample(scale_.read());
+    }
+}
 
-    if (isnan(rawReading) || isinf(rawReading)) {
-        Serial.println("[WEIGHT] Invalid reading from HX711 (NaN/Inf)");
-        return SENSOR_ERROR_VALUE;
+void WeightSensor::pushSample(long raw) {
+    // Spike-rejected sample feeds the buffer; smoothed estimate stays in filter_
+    raw = lroundf(filter_.process((float)raw));
+
+    // Drop the samples leaving each window before overwriting the oldest slot
+    if (sampleCount_ >= SCALE_READ_SAMPLES) {
+        readWindowSum_ -= sampleAt(SCALE_READ_SAMPLES - 1);
+    }
+    if (sampleCount_ >= FEEDING_FAST_READ_SAMPLES) {
+        fastWindowSum_ -= sampleAt(FEEDING_FAST_READ_SAMPLES - 1);
     }
 
-    float weight = rawReading * 4.0f;
+    samples_[sampleHead_] = raw;
+    sampleHead_ = (sampleHead_ + 1) % SCALE_SAMPLE_BUFFER_SIZE;
+    if (sampleCount_ < SCALE_SAMPLE_BUFFER_SIZE) {
+        sampleCount_++;
+    }
 
-    // Return in kg (get_units returns grams with our calibration)
-    float result = weight / 1000.0f;
+    readWindowSum_ += raw;
+    fastWindowSum_ += raw;
+    lastSampleTime_ = millis();
+    totalSamples_++;
+}
 
-    // Sanity check: reject readings outside reasonable range
-    if (result < -100.0f || result > 1000.0f) {
-        Serial.printf("[WEIGHT] Reading out of range: %.2f kg\n", result);
-        return SENSOR_ERROR_VALUE;
+long WeightSensor::sampleAt(uint8_t age) const {
+    return samples_[(sampleHead_ + SCALE_SAMPLE_BUFFER_SIZE - 1 - age) % SCALE_SAMPLE_BUFFER_SIZE];
+}
+
+// ============================================================================
+// WEIGHT READING
+// ============================================================================
+
+float WeightSensor::readWeight() {
+    if (!initialized_) return SENSOR_ERROR_VALUE;
+
+    // Pick up a pending sample so callers never see data older than one conversion
+    update();
+
+    if (filterMode_ != WEIGHT_FILTER_NONE) {
+        return rawToKg(filter_.getValue(), "");
     }
 
-    lastValidWeight_ = result;
-    return result;
+    // Average of the last SCALE_READ_SAMPLES buffered samples (no HX711 wait)
+    uint8_t windowSize = min<uint8_t>(sampleCount_, SCALE_READ_SAMPLES);
+    return rawToKg(windowSize ? (float)readWindowSum_ / windowSize : 0.0f, "");
 }
 
 // ============================================================================
@@ -78,14 +118,34 @@ float WeightSensor::readWeight() {
 float WeightSensor::readWeightFast() {
     if (!initialized_) return SENSOR_ERROR_VALUE;
 
-    // Read fewer samples for faster response during active feeding
-    float rawReading = scale_.get_units(FEEDING_FAST_READ_SAMPLES);
+    update();
+
+    // Fewer samples for faster response during active feeding
+    uint8_t windowSize = min<uint8_t>(sampleCount_, FEEDING_FAST_READ_SAMPLES);
+    return rawToKg(windowSize ? (float)fastWindowSum_ / windowSize : 0.0f, "fast ");
+}
+
+float WeightSensor::getLatestWeight() {
+    if (!initialized_) return SENSOR_ERROR_VALUE;
+    return rawToKg(sampleCount_ ? (float)sampleAt(0) : 0.0f, "latest ");
+}
+
+float WeightSensor::rawToKg(float raw, const char* label) {
+    // HX711 stopped converting (unplugged, power loss) - buffer contents are stale
+    if (sampleCount_ == 0 || millis() - lastSampleTime_ > SCALE_STALE_TIMEOUT) {
+        Serial.printf("[WEIGHT] No %sreading from HX711 for %lu ms\n", label, millis() - lastSampleTime_);
+        return SENSOR_ERROR_VALUE;
+    }
+
+    // Same math as HX711::get_units(): (raw - offset) / scale
+    float rawReading = (raw - scale_.get_offset()) / scale_.get_scale();
 
     if (isnan(rawReading) || isinf(rawReading)) {
-        Serial.println("[WEIGHT] Invalid fast reading from HX711 (NaN/Inf)");
+        Serial.printf("[WEIGHT] Invalid %sreading from HX711 (NaN/Inf)\n", label);
         return SENSOR_ERROR_VALUE;
     }
 
+    // Multiply by 4 (hardware-specific calibration for load cell configuration)
     float weight = rawReading * 4.0f;
 
     // Return in kg (get_units returns grams with our calibration)
@@ -93,7 +153,7 @@ float WeightSensor::readWeightFast() {
 
     // Sanity check: reject readings outside reasonable range
     if (result < -100.0f || result > 1000.0f) {
-        Serial.printf("[WEIGHT] Fast reading out of range: %.2f kg\n", result);
+        Serial.printf("[WEIGHT] Out-of-range %sreading: %.2f kg\n", label, result);
         return SENSOR_ERROR_VALUE;
     }
 
@@ -101,6 +161,48 @@ float WeightSensor::readWeightFast() {
     return result;
 }
 
+// ============================================================================
+// SETTLE DETECTION
+// ============================================================================
+
+uint32_t WeightSensor::getSampleCount() const {
+    return totalSamples_;
+}
+
+bool WeightSensor::isStable(uint32_t sinceSample) const {
+    const uint8_t n = SCALE_STABLE_WINDOW;
+    if (!initialized_ || sampleCount_ < n || totalSamples_ - sinceSample < n) {
+        return false;  // Window would still contain samples from before the marker
+    }
+
+    // Least-squares fit over x = 0..n-1 (oldest..newest): mean, variance, slope
+    float mean = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        mean += sampleAt(i);
+    }
+    mean /= n;
+
+    const float xMean = (n - 1) / 2.0f;
+    float variance = 0.0f;
+    float covariance = 0.0f;
+    float xVariance = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        float dy = sampleAt(i) - mean;
+        float dx = (n - 1 - i) - xMean;
+        variance += dy * dy;
+        covariance += dx * dy;
+        xVariance += dx * dx;
+    }
+    variance /= n;
+
+    // Counts -> grams (grams = counts / scale * 4)
+    float gramsPerCount = 4.0f / fabs(calibrationFactor_);
+    float stddevG = sqrtf(variance) * gramsPerCount;
+    float slopeG = fabs(covariance / xVariance) * gramsPerCount;
+
+    return stddevG <= SCALE_STABLE_MAX_STDDEV_G && slopeG <= SCALE_STABLE_MAX_SLOPE_G;
+}
+
 // ============================================================================
 // TARE (ZERO) SCALE
 // ============================================================================
@@ -110,6 +212,18 @@ bool WeightSensor::tare(uint8_t samples) {
         return false;
     }
 
+    update();
+
+    // Use buffered samples when enough are available (no blocking HX711 reads)
+    if (samples > 0 && samples <= sampleCount_) {
+        int64_t sum = 0;
+        for (uint8_t i = 0; i < samples; i++) {
+            sum += sampleAt(i);
+        }
+        scale_.set_offset((long)(sum / samples));
+        return true;
+    }
+
     scale_.tare(samples);
 
     // Wait for tare to complete
@@ -122,6 +236,10 @@ bool WeightSensor::tare(uint8_t samples) {
 // STATUS CHECKS
 // ============================================================================
 
+bool WeightSensor::isStale() const {
+    return !initialized_ || sampleCount_ == 0 || millis() - lastSampleTime_ > SCALE_STALE_TIMEOUT;
+}
+
 bool WeightSensor::isReady() const {
     if (!initialized_) {
         return false;
@@ -139,13 +257,36 @@ void WeightSensor::setCalibrationFactor(float factor) {
     if (initialized_) {
         scale_.set_scale(calibrationFactor_);
     }
+    configureFilter();
+}
+
+// ============================================================================
+// FILTER CONFIGURATION
+// ============================================================================
+
+void WeightSensor::setFilterMode(WeightFilterMode mode) {
+    filterMode_ = mode;
+    configureFilter();
+}
+
+void WeightSensor::configureFilter() {
+    // grams = counts / scale * 4  ->  counts per gram = scale / 4
+    float countsPerGram = fabs(calibrationFactor_) / 4.0f;
+    filter_.configure(filterMode_, SCALE_EMA_ALPHA,
+                      SCALE_KALMAN_PROCESS_NOISE_G * countsPerGram,
+                      SCALE_KALMAN_MEASUREMENT_NOISE_G * countsPerGram,
+                      SCALE_HAMPEL_MIN_SPREAD_G * countsPerGram);
 }
 
 long WeightSensor::readRaw() {
     if (!initialized_) {
         return 0;
     }
-    return scale_.read_average(SCALE_READ_SAMPLES);
+    uint8_t windowSize = min<uint8_t>(sampleCount_, SCALE_READ_SAMPLES);
+    if (windowSize == 0) {
+        return 0;
+    }
+    return (long)(readWindowSum_ / windowSize);
 }
 
 // ============================================================================
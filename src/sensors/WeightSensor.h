@@ -2,11 +2,16 @@
 
 #include <Arduino.h>
 #include <HX711.h>
+#include "../config/CalibrationConfig.h"
+#include "WeightFilter.h"
 
 // ============================================================================
 // WEIGHT SENSOR (HX711 Load Cell)
 // ============================================================================
 // Manages HX711 weight sensor with tare and calibration
+// Non-blocking: update() clocks out one sample whenever the HX711 has one ready
+// and stores it in a ring buffer, so every read is O(1) and never waits on DOUT
+// Each sample passes through WeightFilter (spike rejection + EMA/Kalman) on arrival
 
 class WeightSensor {
 public:
@@ -15,18 +20,37 @@ public:
     // Initialize sensor
     bool begin(uint8_t doutPin, uint8_t clkPin, float calibrationFactor);
 
-    // Read weight in kg (10 samples - accurate but slow ~1s)
+    // Poll HX711 and buffer a new sample if ready (call from main loop)
+    void update();
+
+    // Read weight in kg (filtered estimate, or mean of last 10 samples if filter mode is NONE)
     float readWeight();
 
-    // Read weight in kg (fewer samples - faster ~300ms, for use during active feeding)
+    // Read weight in kg (mean of last 3 spike-rejected samples - responsive, for use during active feeding)
     float readWeightFast();
 
+    // Newest spike-rejected sample in kg, unsmoothed (for estimators that do their own filtering)
+    float getLatestWeight();
+
+    // Total samples acquired since boot (use as a marker for isStable())
+    uint32_t getSampleCount() const;
+
+    // True when the newest SCALE_STABLE_WINDOW samples were all taken after
+    // `sinceSample` and their spread and trend are within the stable limits
+    bool isStable(uint32_t sinceSample) const;
+
+    // Select smoothing stage at runtime (default SCALE_FILTER_MODE)
+    void setFilterMode(WeightFilterMode mode);
+
     // Tare (zero) the scale
     bool tare(uint8_t samples = 10);
 
     // Check if sensor is ready
     bool isReady() const;
 
+    // No HX711 sample for SCALE_STALE_TIMEOUT (reads would return SENSOR_ERROR_VALUE) - silent check
+    bool isStale() const;
+
     // Set calibration factor
     void setCalibrationFactor(float factor);
 
@@ -42,4 +66,31 @@ private:
     float calibrationFactor_;
     bool initialized_;
     float lastValidWeight_;  // Cache last valid reading for when scale is not ready
+
+    // Per-sample filter chain
+    WeightFilter filter_;
+    WeightFilterMode filterMode_;
+
+    // Sample ring buffer (spike-rejected HX711 counts)
+    long samples_[SCALE_SAMPLE_BUFFER_SIZE];
+    uint8_t sampleHead_;               // Next write position
+    uint8_t sampleCount_;              // Valid samples in buffer
+    unsigned long lastSampleTime_;     // millis() of newest sample
+    uint32_t totalSamples_;            // Monotonic sample counter
+
+    // Running sums over the read windows (keeps readWeight/readWeightFast O(1))
+    int64_t readWindowSum_;
+    int64_t fastWindowSum_;
+
+    // Filter one raw sample, store it and update running sums
+    void pushSample(long raw);
+
+    // Push config values (grams) into the filter in raw counts for the current calibration
+    void configureFilter();
+
+    // Raw sample that is `age` samples old (0 = newest)
+    long sampleAt(uint8_t age) const;
+
+    // Convert a raw count value to kg and validate (SENSOR_ERROR_VALUE on failure)
+    float rawToKg(float raw, const char* label);
 };
@@ -82,3 +82,24 @@ void PreferencesManager::saveDisplayName(const char* name) {
     }
     Serial.printf("[PREFS] Display name saved: %s\n", name);
 }
+
+// ============================================================================
+// DISPENSE MODEL PERSISTENCE
+// ============================================================================
+
+bool PreferencesManager::loadDispenseModel(DispenseModelState& state) {
+    size_t len = 0;
+    if (openNamespace(true)) {
+        len = preferences_.getBytes("dispModel", &state, sizeof(DispenseModelState));
+        closeNamespace();
+    }
+    // Size mismatch = older layout, caller keeps defaults
+    return len == sizeof(DispenseModelState);
+}
+
+void PreferencesManager::saveDispenseModel(const DispenseModelState& state) {
+    if (openNamespace(false)) {
+        preferences_.putBytes("dispModel", &state, sizeof(DispenseModelState));
+        closeNamespace();
+    }
+}
@@ -2,12 +2,13 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include "../config/DataStructures.h"
 
 // ============================================================================
 // PREFERENCES MANAGER
 // ============================================================================
 // Simple wrapper for ESP32 NVS flash storage
-// Stores: Water flow total, Tare offset
+// Stores: Water flow total, Tare offset, Display name, Dispense model
 
 class PreferencesManager {
 public:
@@ -25,6 +26,10 @@ public:
     String loadDisplayName();
     void saveDisplayName(const char* name);
 
+    // Learned dispense model persistence (false if nothing stored)
+    bool loadDispenseModel(DispenseModelState& state);
+    void saveDispenseModel(const DispenseModelState& state);
+
 private:
     Preferences preferences_;
 